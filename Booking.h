@@ -5,6 +5,9 @@
 
 enum class BookingStatus { Confirmed, Cancelled, CheckedOut };
 
+// For statuses read back from files, before casting
+inline bool isBookingStatus(int v) { return v >= 0 && v <= (int)BookingStatus::CheckedOut; }
+
 class Booking {
 public:
     int bookingId;
@@ -13,12 +16,17 @@ public:
     int roomTypeId;
     int days;
     BookingStatus status;
+    int checkIn;   // day number (see Date.h); 0 for bookings saved before dates
+    double amount = 0.0;   // room charge quoted when booked; 0 for bookings
+                           // saved before rate plans (base price * days)
 
     Booking() = default;
 
-    Booking(int b, int c, int r, int rt, int d)
+    Booking(int b, int c, int r, int rt, int d, int in = 0)
         : bookingId(b), custId(c), roomId(r), roomTypeId(rt),
-          days(d), status(BookingStatus::Confirmed) {}
+          days(d), status(BookingStatus::Confirmed), checkIn(in) {}
+
+    int checkOut() const { return checkIn + days; }
 };
 
 #endif
@@ -0,0 +1,587 @@
+#include "BulkIO.h"
+#include "DatParser.h"
+#include "Date.h"
+#include "JsonWriter.h"
+
+#include <cctype>
+#include <charconv>
+#include <future>
+#include <string_view>
+
+namespace bulk {
+
+/* ================= Helpers ================= */
+
+static bool sameText(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++)
+        if (std::tolower((unsigned char)a[i]) != std::tolower((unsigned char)b[i])) return false;
+    return true;
+}
+
+static std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+    return s;
+}
+
+template <class T>
+static bool toNumber(std::string_view s, T& v) {
+    s = trim(s);
+    if (s.empty()) return false;
+    auto res = std::from_chars(s.data(), s.data() + s.size(), v);
+    return res.ec == std::errc() && res.ptr == s.data() + s.size();
+}
+
+// YYYY-MM-DD without going through sscanf
+static bool toDay(std::string_view s, int& day) {
+    s = trim(s);
+    if (s.size() != 10 || s[4] != '-' || s[7] != '-') return false;
+    int y, m, d;
+    if (!toNumber(s.substr(0, 4), y) || !toNumber(s.substr(5, 2), m) || !toNumber(s.substr(8, 2), d))
+        return false;
+    if (m < 1 || m > 12 || d < 1 || d > 31) return false;
+
+    day = daysFromCivil(y, m, d);
+    int cy, cm, cd;
+    civilFromDays(day, cy, cm, cd);
+    return cy == y && cm == m && cd == d;
+}
+
+// A status name from the list, or its index
+static bool toStatus(std::string_view s, const char* const* names, int count, int& v) {
+    s = trim(s);
+    if (toNumber(s, v)) return v >= 0 && v < count;
+    for (v = 0; v < count; v++)
+        if (sameText(s, names[v])) return true;
+    return false;
+}
+
+static bool fail(std::string& why, const char* msg) {
+    why = msg;
+    return false;
+}
+
+static const char* const ROOM_STATUS[] = { "available", "booked", "maintenance" };
+static const char* const BOOKING_STATUS[] = { "confirmed", "cancelled", "checkedout" };
+
+Format formatOf(const std::string& path) {
+    auto endsWith = [&](const char* ext) {
+        std::string_view e(ext);
+        return path.size() >= e.size() && sameText(std::string_view(path).substr(path.size() - e.size()), e);
+    };
+    return (endsWith(".ndjson") || endsWith(".jsonl")) ? Format::Ndjson : Format::Csv;
+}
+
+const char* extension(Format f) {
+    return (f == Format::Ndjson) ? ".ndjson" : ".csv";
+}
+
+void Batch::reject(const std::string& path, size_t line, const std::string& why) {
+    rejected++;
+    if (errors.size() < MAX_ERRORS) errors.push_back(path + ":" + std::to_string(line) + ": " + why);
+}
+
+/* ================= Line Splitting ================= */
+
+// Comma-separated fields with RFC 4180 quoting. Quoted fields that
+// contain doubled quotes are unescaped into scratch.
+static bool splitCsv(std::string_view line, std::vector<std::string_view>& out,
+                     std::deque<std::string>& scratch) {
+    out.clear();
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+    size_t i = 0;
+    while (true) {
+        while (i < line.size() && line[i] == ' ') i++;
+
+        if (i < line.size() && line[i] == '"') {
+            size_t start = ++i;
+            bool doubled = false;
+            while (true) {
+                if (i >= line.size()) return false;   // unterminated
+                if (line[i] == '"') {
+                    if (i + 1 < line.size() && line[i + 1] == '"') {
+                        doubled = true;
+                        i += 2;
+                        continue;
+                    }
+                    break;
+                }
+                i++;
+            }
+            std::string_view raw = line.substr(start, i - start);
+            i++;
+            while (i < line.size() && line[i] == ' ') i++;
+            if (i < line.size() && line[i] != ',') return false;
+
+            if (doubled) {
+                std::string s;
+                for (size_t k = 0; k < raw.size(); k++) {
+                    s += raw[k];
+                    if (raw[k] == '"') k++;
+                }
+                scratch.push_back(std::move(s));
+                out.push_back(scratch.back());
+            } else {
+                out.push_back(raw);
+            }
+        } else {
+            size_t comma = line.find(',', i);
+            size_t end = (comma == std::string_view::npos) ? line.size() : comma;
+            out.push_back(trim(line.substr(i, end - i)));
+            i = end;
+        }
+
+        if (i >= line.size()) return true;
+        i++;   // past the comma
+    }
+}
+
+static void appendUtf8(std::string& s, unsigned cp) {
+    if (cp < 0x80) {
+        s += (char)cp;
+    } else if (cp < 0x800) {
+        s += (char)(0xC0 | (cp >> 6));
+        s += (char)(0x80 | (cp & 0x3F));
+    } else {
+        s += (char)(0xE0 | (cp >> 12));
+        s += (char)(0x80 | ((cp >> 6) & 0x3F));
+        s += (char)(0x80 | (cp & 0x3F));
+    }
+}
+
+// A JSON string starting at line[i] == '"'; escapes go through scratch
+static bool jsonString(std::string_view line, size_t& i, std::string_view& out,
+                       std::deque<std::string>& scratch) {
+    size_t start = ++i;
+    bool escaped = false;
+    while (i < line.size() && line[i] != '"') {
+        if (line[i] == '\\') {
+            escaped = true;
+            i++;
+        }
+        i++;
+    }
+    if (i >= line.size()) return false;
+    std::string_view raw = line.substr(start, i - start);
+    i++;
+
+    if (!escaped) {
+        out = raw;
+        return true;
+    }
+
+    std::string s;
+    for (size_t k = 0; k < raw.size(); k++) {
+        if (raw[k] != '\\') {
+            s += raw[k];
+            continue;
+        }
+        char c = raw[++k];
+        switch (c) {
+            case 'b': s += '\b'; break;
+            case 'f': s += '\f'; break;
+            case 'n': s += '\n'; break;
+            case 'r': s += '\r'; break;
+            case 't': s += '\t'; break;
+            case 'u': {
+                unsigned cp = 0;
+                if (k + 4 >= raw.size()) return false;
+                auto res = std::from_chars(raw.data() + k + 1, raw.data() + k + 5, cp, 16);
+                if (res.ptr != raw.data() + k + 5) return false;
+                appendUtf8(s, cp);
+                k += 4;
+                break;
+            }
+            default: s += c;
+        }
+    }
+    scratch.push_back(std::move(s));
+    out = scratch.back();
+    return true;
+}
+
+// One flat JSON object as key/value pairs. Values are strings (unquoted)
+// or the raw text of numbers, booleans and null.
+static bool splitJson(std::string_view line,
+                      std::vector<std::pair<std::string_view, std::string_view>>& out,
+                      std::deque<std::string>& scratch) {
+    out.clear();
+    size_t i = 0;
+    auto skip = [&] {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) i++;
+    };
+
+    skip();
+    if (i >= line.size() || line[i++] != '{') return false;
+    skip();
+    if (i < line.size() && line[i] == '}') return true;
+
+    while (true) {
+        skip();
+        std::string_view key, value;
+        if (i >= line.size() || line[i] != '"' || !jsonString(line, i, key, scratch)) return false;
+        skip();
+        if (i >= line.size() || line[i++] != ':') return false;
+        skip();
+
+        if (i < line.size() && line[i] == '"') {
+            if (!jsonString(line, i, value, scratch)) return false;
+        } else {
+            size_t start = i;
+            while (i < line.size() && std::string_view(",} \t\r").find(line[i]) == std::string_view::npos)
+                i++;
+            value = line.substr(start, i - start);
+            if (value.empty() || value.front() == '{' || value.front() == '[') return false;
+        }
+        out.emplace_back(key, value);
+
+        skip();
+        if (i >= line.size()) return false;
+        if (line[i] == '}') return true;
+        if (line[i++] != ',') return false;
+    }
+}
+
+/* ================= Table Reader ================= */
+
+// Values of one record by table column; has[k] is 0 for absent columns
+struct Fields {
+    std::vector<std::string_view> v;
+    std::vector<char> has;
+};
+
+// Parses every record of a CSV or NDJSON file in parallel chunks.
+// parse(Fields&, T&, std::string& why) returns false to reject a row.
+template <class T, class Parse>
+static bool readTable(const std::string& path, const std::vector<const char*>& columns,
+                      size_t required, Parse parse, std::vector<T>& rows,
+                      std::vector<size_t>& lines, Batch& b) {
+    b.texts.push_back(std::make_unique<std::string>());
+    std::string& text = *b.texts.back();
+    if (!readWholeFile(path, text)) {
+        b.errors.push_back(path + ": cannot read file");
+        return false;
+    }
+
+    Format format = formatOf(path);
+    std::string_view body(text);
+    size_t firstLine = 1;
+
+    // CSV header: column name -> position in the row
+    std::vector<int> position(columns.size(), -1);
+    if (format == Format::Csv) {
+        std::deque<std::string> scratch;
+        std::vector<std::string_view> header;
+        while (!body.empty()) {
+            size_t nl = body.find('\n');
+            std::string_view line = body.substr(0, nl);
+            body.remove_prefix(nl == std::string_view::npos ? body.size() : nl + 1);
+            if (trim(line).empty()) {
+                firstLine++;
+                continue;
+            }
+            if (!splitCsv(line, header, scratch)) header.clear();
+            break;
+        }
+        firstLine++;
+
+        for (size_t k = 0; k < columns.size(); k++)
+            for (size_t p = 0; p < header.size(); p++)
+                if (sameText(trim(header[p]), columns[k])) position[k] = (int)p;
+
+        for (size_t k = 0; k < required; k++) {
+            if (position[k] < 0) {
+                b.errors.push_back(path + ": missing column " + columns[k]);
+                return false;
+            }
+        }
+    }
+
+    struct Part {
+        std::vector<T> rows;
+        std::vector<size_t> lines;                              // chunk-relative
+        std::vector<std::pair<size_t, std::string>> rejected;   // chunk-relative
+        size_t lineCount = 0;
+        std::unique_ptr<std::deque<std::string>> scratch = std::make_unique<std::deque<std::string>>();
+    };
+
+    std::vector<size_t> cut = chunkCuts(body, 4 << 20);
+
+    auto parseChunk = [&](size_t c) {
+        Part part;
+        std::string_view chunk = body.substr(cut[c], cut[c + 1] - cut[c]);
+        std::vector<std::string_view> csv;
+        std::vector<std::pair<std::string_view, std::string_view>> json;
+        Fields f;
+        f.v.resize(columns.size());
+        f.has.resize(columns.size());
+        std::string why;
+
+        for (size_t line = 0; !chunk.empty(); line++) {
+            size_t nl = chunk.find('\n');
+            std::string_view text = chunk.substr(0, nl);
+            chunk.remove_prefix(nl == std::string_view::npos ? chunk.size() : nl + 1);
+            part.lineCount++;
+            if (trim(text).empty()) continue;
+
+            std::fill(f.has.begin(), f.has.end(), 0);
+            bool ok;
+            if (format == Format::Csv) {
+                ok = splitCsv(text, csv, *part.scratch);
+                for (size_t k = 0; ok && k < columns.size(); k++) {
+                    if (position[k] >= 0 && (size_t)position[k] < csv.size()) {
+                        f.v[k] = csv[(size_t)position[k]];
+                        f.has[k] = !f.v[k].empty();
+                    }
+                }
+            } else {
+                ok = splitJson(text, json, *part.scratch);
+                for (const auto& kv : json) {
+                    for (size_t k = 0; k < columns.size(); k++) {
+                        if (sameText(kv.first, columns[k])) {
+                            f.v[k] = kv.second;
+                            f.has[k] = !kv.second.empty() && kv.second != "null";
+                        }
+                    }
+                }
+            }
+            if (!ok) {
+                part.rejected.emplace_back(line, "malformed record");
+                continue;
+            }
+
+            why.clear();
+            for (size_t k = 0; k < required && why.empty(); k++)
+                if (!f.has[k]) why = std::string("missing ") + columns[k];
+
+            T row;
+            if (why.empty() && parse(f, row, why)) {
+                part.rows.push_back(row);
+                part.lines.push_back(line);
+            } else {
+                part.rejected.emplace_back(line, why);
+            }
+        }
+        return part;
+    };
+
+    std::vector<std::future<Part>> pending;
+    for (size_t c = 1; c + 1 < cut.size(); c++)
+        pending.push_back(std::async(std::launch::async, parseChunk, c));
+
+    std::vector<Part> parts;
+    parts.push_back(parseChunk(0));
+    for (auto& f : pending) parts.push_back(f.get());
+
+    size_t total = 0;
+    for (const auto& p : parts) total += p.rows.size();
+    rows.reserve(rows.size() + total);
+    lines.reserve(lines.size() + total);
+
+    size_t base = firstLine;
+    for (auto& p : parts) {
+        rows.insert(rows.end(), p.rows.begin(), p.rows.end());
+        for (size_t l : p.lines) lines.push_back(base + l);
+        for (const auto& r : p.rejected) b.reject(path, base + r.first, r.second);
+        base += p.lineCount;
+        b.unescaped.push_back(std::move(p.scratch));
+    }
+    return true;
+}
+
+bool readRooms(const std::string& path, Batch& b) {
+    b.roomsPath = path;
+    return readTable(path, { "roomId", "typeId", "status", "customPrice" }, 2,
+        [](const Fields& f, Room& r, std::string& why) {
+            int id, type, status = 0;
+            double price = 0.0;
+            if (!toNumber(f.v[0], id) || id <= 0) return fail(why, "bad roomId");
+            if (!toNumber(f.v[1], type)) return fail(why, "bad typeId");
+            if (f.has[2] && !toStatus(f.v[2], ROOM_STATUS, 3, status)) return fail(why, "bad status");
+            if (f.has[3] && (!toNumber(f.v[3], price) || price < 0)) return fail(why, "bad customPrice");
+
+            r = Room(id, type, price);
+            r.status = (RoomStatus)status;
+            return true;
+        },
+        b.rooms, b.roomLines, b);
+}
+
+bool readCustomers(const std::string& path, Batch& b) {
+    b.customersPath = path;
+    return readTable(path, { "custId", "name", "phone", "email" }, 2,
+        [](const Fields& f, Customer& c, std::string& why) {
+            int id;
+            if (!toNumber(f.v[0], id) || id <= 0) return fail(why, "bad custId");
+
+            c = Customer(id, f.v[1], f.has[2] ? f.v[2] : std::string_view(),
+                         f.has[3] ? f.v[3] : std::string_view());
+            return true;
+        },
+        b.customers, b.customerLines, b);
+}
+
+bool readBookings(const std::string& path, Batch& b) {
+    b.bookingsPath = path;
+    return readTable(path, { "bookingId", "custId", "roomId", "checkIn", "days", "status", "amount" }, 5,
+        [](const Fields& f, Booking& bk, std::string& why) {
+            int id, cust, room, checkIn, days, status = 0;
+            double amount = 0.0;
+            if (!toNumber(f.v[0], id) || id <= 0) return fail(why, "bad bookingId");
+            if (!toNumber(f.v[1], cust)) return fail(why, "bad custId");
+            if (!toNumber(f.v[2], room)) return fail(why, "bad roomId");
+            if (!toDay(f.v[3], checkIn)) return fail(why, "bad checkIn (YYYY-MM-DD)");
+            if (!toNumber(f.v[4], days) || days < 1) return fail(why, "bad days");
+            if (f.has[5] && !toStatus(f.v[5], BOOKING_STATUS, 3, status)) return fail(why, "bad status");
+            if (f.has[6] && (!toNumber(f.v[6], amount) || amount < 0)) return fail(why, "bad amount");
+
+            // The room type is filled in from the room on import
+            bk = Booking(id, cust, room, 0, days, checkIn);
+            bk.status = (BookingStatus)status;
+            bk.amount = amount;
+            return true;
+        },
+        b.bookings, b.bookingLines, b);
+}
+
+/* ================= Writers ================= */
+
+// Output buffered in memory and handed to the stream in large pieces
+class Buffer {
+public:
+    explicit Buffer(std::ostream& o) : out(o) { s.reserve(FLUSH_AT + 4096); }
+    ~Buffer() { flush(); }
+
+    Buffer& operator<<(std::string_view v) {
+        s.append(v.data(), v.size());
+        return *this;
+    }
+    Buffer& operator<<(char c) {
+        s += c;
+        return *this;
+    }
+    template <class T>
+    Buffer& num(T v) {
+        char buf[32];
+        auto res = std::to_chars(buf, buf + sizeof(buf), v);
+        s.append(buf, (size_t)(res.ptr - buf));
+        return *this;
+    }
+    Buffer& csv(std::string_view v) {
+        bool quote = !v.empty() && (v.front() == ' ' || v.back() == ' ' ||
+                                    v.find_first_of(",\"\r\n") != std::string_view::npos);
+        if (!quote) return *this << v;
+        s += '"';
+        for (char c : v) {
+            if (c == '"') s += '"';
+            s += c;
+        }
+        s += '"';
+        return *this;
+    }
+    void endRecord() {
+        s += '\n';
+        if (s.size() >= FLUSH_AT) flush();
+    }
+    void flush() {
+        out.write(s.data(), (std::streamsize)s.size());
+        s.clear();
+    }
+
+private:
+    static constexpr size_t FLUSH_AT = 1 << 20;
+    std::ostream& out;
+    std::string s;
+};
+
+void writeRooms(std::ostream& out, const std::vector<Room>& rooms, Format f) {
+    Buffer o(out);
+    JsonWriter w;
+    if (f == Format::Csv) {
+        o << "roomId,typeId,status,customPrice";
+        o.endRecord();
+    }
+    for (const auto& r : rooms) {
+        const char* status = ROOM_STATUS[(int)r.status];
+        if (f == Format::Csv) {
+            o.num(r.roomId) << ',';
+            o.num(r.typeId) << ',' << status << ',';
+            o.num(r.customPrice);
+        } else {
+            w.clear();
+            w.beginObject()
+                .field("roomId", r.roomId)
+                .field("typeId", r.typeId)
+                .field("status", status)
+                .field("customPrice", r.customPrice)
+                .endObject();
+            o << w.str();
+        }
+        o.endRecord();
+    }
+}
+
+void writeCustomers(std::ostream& out, const std::vector<Customer>& customers, Format f) {
+    Buffer o(out);
+    JsonWriter w;
+    if (f == Format::Csv) {
+        o << "custId,name,phone,email";
+        o.endRecord();
+    }
+    for (const auto& c : customers) {
+        if (f == Format::Csv) {
+            o.num(c.custId) << ',';
+            o.csv(c.name) << ',';
+            o.csv(c.phone) << ',';
+            o.csv(c.email);
+        } else {
+            w.clear();
+            w.beginObject()
+                .field("custId", c.custId)
+                .field("name", c.name)
+                .field("phone", c.phone)
+                .field("email", c.email)
+                .endObject();
+            o << w.str();
+        }
+        o.endRecord();
+    }
+}
+
+void writeBookings(std::ostream& out, const std::vector<Booking>& bookings, Format f) {
+    Buffer o(out);
+    JsonWriter w;
+    if (f == Format::Csv) {
+        o << "bookingId,custId,roomId,checkIn,days,status,amount";
+        o.endRecord();
+    }
+    for (const auto& b : bookings) {
+        // Bookings from before dates were recorded have no check-in
+        std::string checkIn = b.checkIn ? formatDate(b.checkIn) : "";
+        const char* status = BOOKING_STATUS[(int)b.status];
+        if (f == Format::Csv) {
+            o.num(b.bookingId) << ',';
+            o.num(b.custId) << ',';
+            o.num(b.roomId) << ',' << checkIn << ',';
+            o.num(b.days) << ',' << status << ',';
+            o.num(b.amount);
+        } else {
+            w.clear();
+            w.beginObject()
+                .field("bookingId", b.bookingId)
+                .field("custId", b.custId)
+                .field("roomId", b.roomId)
+                .field("checkIn", checkIn)
+                .field("days", b.days)
+                .field("status", status)
+                .field("amount", b.amount)
+                .endObject();
+            o << w.str();
+        }
+        o.endRecord();
+    }
+}
+
+} // namespace bulk
@@ -0,0 +1,80 @@
+#ifndef BULKIO_H
+#define BULKIO_H
+
+#include <deque>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Room.h"
+#include "Customer.h"
+#include "Booking.h"
+
+/*
+ * Bulk import and export of rooms, guests and bookings as CSV or NDJSON,
+ * for onboarding a property or migrating from another system.
+ *
+ * CSV files start with a header row naming their columns (any order);
+ * NDJSON files hold one flat object per line with the same keys.
+ *
+ *   rooms:      roomId, typeId, status, customPrice
+ *   customers:  custId, name, phone, email
+ *   bookings:   bookingId, custId, roomId, checkIn (YYYY-MM-DD), days, status,
+ *               amount
+ *
+ * status, customPrice and amount are optional (Available / Confirmed / 0).
+ * Statuses may be names ("maintenance", "checkedout") or their numbers.
+ * Records may not span lines.
+ *
+ * The read* functions parse a file in parallel chunks into a Batch.
+ * Hotel::importBatch() then validates the references and adds
+ * everything at once (see Hotel.h).
+ */
+namespace bulk {
+
+enum class Format { Csv, Ndjson };
+
+// From the file extension: .ndjson / .jsonl, anything else is CSV
+Format formatOf(const std::string& path);
+const char* extension(Format f);
+
+struct Batch {
+    std::vector<Room> rooms;
+    std::vector<Customer> customers;     // views into texts / unescaped
+    std::vector<Booking> bookings;
+
+    // Source file and line of every row, for error messages
+    std::string roomsPath, customersPath, bookingsPath;
+    std::vector<size_t> roomLines, customerLines, bookingLines;
+
+    // Rows accepted by Hotel::importBatch(), and rows it skipped because
+    // the same record was already stored
+    size_t importedRooms = 0, importedCustomers = 0, importedBookings = 0;
+    size_t unchanged = 0;
+
+    // Every rejected row is counted; the first MAX_ERRORS are described
+    static constexpr size_t MAX_ERRORS = 50;
+    size_t rejected = 0;
+    std::vector<std::string> errors;
+
+    void reject(const std::string& path, size_t line, const std::string& why);
+
+    // Storage behind the customers' string_views
+    std::vector<std::unique_ptr<std::string>> texts;
+    std::vector<std::unique_ptr<std::deque<std::string>>> unescaped;
+};
+
+// Parse a whole file into the batch; false if it cannot be read or
+// lacks a required column. Malformed rows are rejected, not fatal.
+bool readRooms(const std::string& path, Batch& b);
+bool readCustomers(const std::string& path, Batch& b);
+bool readBookings(const std::string& path, Batch& b);
+
+void writeRooms(std::ostream& out, const std::vector<Room>& rooms, Format f);
+void writeCustomers(std::ostream& out, const std::vector<Customer>& customers, Format f);
+void writeBookings(std::ostream& out, const std::vector<Booking>& bookings, Format f);
+
+} // namespace bulk
+
+#endif
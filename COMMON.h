@@ -15,6 +15,9 @@
 // Room status
 enum class RoomStatus { Available, Booked, Maintenance };
 
+// For statuses read back from files, before casting
+inline bool isRoomStatus(int v) { return v >= 0 && v <= (int)RoomStatus::Maintenance; }
+
 // Convert status to text
 inline std::string statusToString(RoomStatus s) {
     switch (s) {
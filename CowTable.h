@@ -0,0 +1,139 @@
+#ifndef COWTABLE_H
+#define COWTABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+/*
+ * Copy-on-write table in fixed-size chunks, for point-in-time reads.
+ *
+ * view() pins the current contents in O(1) (one shared_ptr copy); the
+ * view never changes afterwards and needs no lock to read. A write to a
+ * table with pinned views copies the chunk directory once, and each
+ * chunk it touches once, so writers keep going at full speed and pay a
+ * few microseconds per report instead of waiting for it. With no views
+ * alive, writes go straight into the chunks.
+ *
+ * The table itself is not thread-safe: writes and view() need the same
+ * external lock as the source table (Hotel's tableMutex; view() under a
+ * shared lock is enough). Views may then be read and dropped anywhere.
+ */
+template <class T>
+class CowTable {
+    static constexpr size_t SHIFT = 10;
+    static constexpr size_t MASK = (size_t(1) << SHIFT) - 1;
+
+    using Chunk = std::vector<T>;
+    using Dir = std::vector<std::shared_ptr<Chunk>>;
+
+public:
+    static constexpr size_t CHUNK = size_t(1) << SHIFT;
+
+    class View {
+    public:
+        View() = default;
+
+        size_t size() const { return n; }
+        bool empty() const { return n == 0; }
+        const T& operator[](size_t i) const { return (*(*dir)[i >> SHIFT])[i & MASK]; }
+
+        class const_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
+
+            const_iterator(const View* v, size_t i) : view(v), i(i) {}
+            const T& operator*() const { return (*view)[i]; }
+            const T* operator->() const { return &(*view)[i]; }
+            const_iterator& operator++() { ++i; return *this; }
+            bool operator==(const const_iterator& o) const { return i == o.i; }
+            bool operator!=(const const_iterator& o) const { return i != o.i; }
+
+        private:
+            const View* view;
+            size_t i;
+        };
+
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, n); }
+
+    private:
+        friend class CowTable;
+        View(std::shared_ptr<const Dir> d, size_t n) : dir(std::move(d)), n(n) {}
+
+        std::shared_ptr<const Dir> dir;
+        size_t n = 0;
+    };
+
+    CowTable() : dir(std::make_shared<Dir>()) {}
+
+    size_t size() const { return n; }
+
+    View view() const { return View(dir, n); }
+
+    // Replaces the contents; views already pinned keep the old ones
+    template <class Rows>
+    void assign(const Rows& rows, size_t count) {
+        auto fresh = std::make_shared<Dir>();
+        fresh->reserve((count + CHUNK - 1) / CHUNK);
+        for (size_t i = 0; i < count; i++) {
+            if ((i & MASK) == 0) {
+                fresh->push_back(std::make_shared<Chunk>());
+                fresh->back()->reserve(CHUNK);
+            }
+            fresh->back()->push_back(rows[i]);
+        }
+        dir = std::move(fresh);
+        n = count;
+    }
+
+    void push_back(const T& row) {
+        if ((n & MASK) == 0) {
+            ownDir();
+            dir->push_back(std::make_shared<Chunk>());
+            dir->back()->reserve(CHUNK);
+        }
+        ownChunk(n >> SHIFT).push_back(row);
+        n++;
+    }
+
+    void set(size_t i, const T& row) { ownChunk(i >> SHIFT)[i & MASK] = row; }
+
+private:
+    std::shared_ptr<Dir> dir;
+    size_t n = 0;
+
+    // use_count() is a relaxed read: seeing 1 means every view that
+    // shared the pointer is gone, and the fence orders its last reads
+    // before our writes
+    template <class P>
+    static bool unique(const std::shared_ptr<P>& p) {
+        if (p.use_count() != 1) return false;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return true;
+    }
+
+    void ownDir() {
+        if (!unique(dir)) dir = std::make_shared<Dir>(*dir);
+    }
+
+    Chunk& ownChunk(size_t c) {
+        ownDir();
+        std::shared_ptr<Chunk>& chunk = (*dir)[c];
+        if (!unique(chunk)) {
+            auto copy = std::make_shared<Chunk>();
+            copy->reserve(CHUNK);
+            copy->assign(chunk->begin(), chunk->end());
+            chunk = std::move(copy);
+        }
+        return *chunk;
+    }
+};
+
+#endif
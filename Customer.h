@@ -1,18 +1,19 @@
 #ifndef CUSTOMER_H
 #define CUSTOMER_H
 
-#include <string>
+#include <string_view>
 
+// Text fields are views into the owning Hotel's StringPool
 class Customer {
 public:
     int custId;
-    std::string name;
-    std::string phone;
-    std::string email;
+    std::string_view name;
+    std::string_view phone;
+    std::string_view email;
 
     Customer() = default;
 
-    Customer(int id, const std::string &n, const std::string &ph, const std::string &em)
+    Customer(int id, std::string_view n, std::string_view ph, std::string_view em)
         : custId(id), name(n), phone(ph), email(em) {}
 };
 
@@ -0,0 +1,182 @@
+#ifndef CUSTOMERINDEX_H
+#define CUSTOMERINDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Customer.h"
+
+// Hotel::findCustomers() filter: empty fields match anything
+struct CustomerQuery {
+    std::string phone;
+    std::string email;
+    std::string namePrefix;
+    size_t limit = 50;
+};
+
+/*
+ * Secondary indexes over Hotel::customers, mapping to table slots:
+ * exact phone and email lookups (hash) and a name-prefix search (ordered).
+ *
+ * Keys are the customers' own string_views; matching is normalised on
+ * the fly instead of storing normalised copies. Phones compare on their
+ * digits only ("+91 98-765" == "9198765"), emails and names ignore ASCII
+ * case.
+ */
+class CustomerIndex {
+private:
+    static char lower(char c) { return (c >= 'A' && c <= 'Z') ? (char)(c + 'a' - 'A') : c; }
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    struct PhoneHash {
+        size_t operator()(std::string_view s) const {
+            uint64_t h = 1469598103934665603ULL;
+            for (char c : s)
+                if (isDigit(c)) h = (h ^ (unsigned char)c) * 1099511628211ULL;
+            return (size_t)h;
+        }
+    };
+
+    struct PhoneEq {
+        bool operator()(std::string_view a, std::string_view b) const {
+            size_t i = 0, j = 0;
+            while (true) {
+                while (i < a.size() && !isDigit(a[i])) i++;
+                while (j < b.size() && !isDigit(b[j])) j++;
+                if (i == a.size() || j == b.size()) return i == a.size() && j == b.size();
+                if (a[i++] != b[j++]) return false;
+            }
+        }
+    };
+
+    struct NoCaseHash {
+        size_t operator()(std::string_view s) const {
+            uint64_t h = 1469598103934665603ULL;
+            for (char c : s) h = (h ^ (unsigned char)lower(c)) * 1099511628211ULL;
+            return (size_t)h;
+        }
+    };
+
+    struct NoCaseEq {
+        bool operator()(std::string_view a, std::string_view b) const {
+            if (a.size() != b.size()) return false;
+            for (size_t i = 0; i < a.size(); i++)
+                if (lower(a[i]) != lower(b[i])) return false;
+            return true;
+        }
+    };
+
+    struct NoCaseLess {
+        bool operator()(std::string_view a, std::string_view b) const {
+            size_t n = std::min(a.size(), b.size());
+            for (size_t i = 0; i < n; i++) {
+                char x = lower(a[i]), y = lower(b[i]);
+                if (x != y) return x < y;
+            }
+            return a.size() < b.size();
+        }
+    };
+
+    static bool hasPhoneDigits(std::string_view s) {
+        return std::any_of(s.begin(), s.end(), isDigit);
+    }
+
+    std::unordered_multimap<std::string_view, size_t, PhoneHash, PhoneEq> phones;
+    std::unordered_multimap<std::string_view, size_t, NoCaseHash, NoCaseEq> emails;
+    std::multimap<std::string_view, size_t, NoCaseLess> names;
+
+    template <class Map>
+    static void eraseSlot(Map& m, std::string_view key, size_t slot) {
+        auto range = m.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == slot) {
+                m.erase(it);
+                return;
+            }
+        }
+    }
+
+    template <class Map>
+    static std::vector<size_t> slotsOf(const Map& m, std::string_view key) {
+        std::vector<size_t> out;
+        auto range = m.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it) out.push_back(it->second);
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+public:
+    void clear() {
+        phones.clear();
+        emails.clear();
+        names.clear();
+    }
+
+    // Bulk build after a load: names are sorted once and appended in
+    // order, which makes each ordered insert amortised O(1)
+    void build(const std::vector<Customer>& customers) {
+        clear();
+        phones.reserve(customers.size());
+        emails.reserve(customers.size());
+
+        std::vector<size_t> order;
+        order.reserve(customers.size());
+        for (size_t i = 0; i < customers.size(); i++) {
+            const Customer& c = customers[i];
+            if (hasPhoneDigits(c.phone)) phones.emplace(c.phone, i);
+            if (!c.email.empty()) emails.emplace(c.email, i);
+            if (!c.name.empty()) order.push_back(i);
+        }
+
+        NoCaseLess less;
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return less(customers[a].name, customers[b].name);
+        });
+        for (size_t i : order) names.emplace_hint(names.end(), customers[i].name, i);
+    }
+
+    void add(const Customer& c, size_t slot) {
+        if (hasPhoneDigits(c.phone)) phones.emplace(c.phone, slot);
+        if (!c.email.empty()) emails.emplace(c.email, slot);
+        if (!c.name.empty()) names.emplace(c.name, slot);
+    }
+
+    void remove(const Customer& c, size_t slot) {
+        eraseSlot(phones, c.phone, slot);
+        eraseSlot(emails, c.email, slot);
+        eraseSlot(names, c.name, slot);
+    }
+
+    std::vector<size_t> byPhone(std::string_view phone) const {
+        return hasPhoneDigits(phone) ? slotsOf(phones, phone) : std::vector<size_t>();
+    }
+
+    std::vector<size_t> byEmail(std::string_view email) const {
+        return email.empty() ? std::vector<size_t>() : slotsOf(emails, email);
+    }
+
+    // Slots whose name starts with prefix, in name order, at most limit
+    std::vector<size_t> byNamePrefix(std::string_view prefix, size_t limit) const {
+        std::vector<size_t> out;
+        NoCaseEq eq;
+        for (auto it = names.lower_bound(prefix); it != names.end() && out.size() < limit; ++it) {
+            if (it->first.size() < prefix.size() || !eq(it->first.substr(0, prefix.size()), prefix))
+                break;
+            out.push_back(it->second);
+        }
+        return out;
+    }
+
+    static bool samePhone(std::string_view a, std::string_view b) { return PhoneEq()(a, b); }
+    static bool sameEmail(std::string_view a, std::string_view b) { return NoCaseEq()(a, b); }
+    static bool hasNamePrefix(std::string_view name, std::string_view prefix) {
+        return name.size() >= prefix.size() && NoCaseEq()(name.substr(0, prefix.size()), prefix);
+    }
+};
+
+#endif
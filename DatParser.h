@@ -0,0 +1,130 @@
+#ifndef DATPARSER_H
+#define DATPARSER_H
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <future>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Parsing helpers for the whitespace-separated .dat tables. A file is
+// read in one go, cut into chunks on line boundaries and the chunks are
+// parsed on separate threads; small files are parsed inline.
+
+// Whitespace-separated fields of one line
+class LineFields {
+private:
+    const char* p;
+    const char* end;
+
+    std::string_view token() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+        const char* start = p;
+        while (p < end && *p != ' ' && *p != '\t' && *p != '\r') p++;
+        return std::string_view(start, (size_t)(p - start));
+    }
+
+    template <class T>
+    bool number(T& v) {
+        std::string_view t = token();
+        if (t.empty()) return false;
+        auto res = std::from_chars(t.data(), t.data() + t.size(), v);
+        return res.ec == std::errc() && res.ptr == t.data() + t.size();
+    }
+
+public:
+    explicit LineFields(std::string_view line) : p(line.data()), end(line.data() + line.size()) {}
+
+    bool next(int& v) { return number(v); }
+    bool next(double& v) { return number(v); }
+    // The view points into the line being parsed
+    bool next(std::string_view& v) {
+        v = token();
+        return !v.empty();
+    }
+};
+
+inline bool readWholeFile(const std::string& path, std::string& out) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return false;
+
+    std::streamsize size = f.tellg();
+    out.resize(size > 0 ? (size_t)size : 0);
+    f.seekg(0);
+    return size <= 0 || (bool)f.read(&out[0], size);
+}
+
+// Offsets that cut text into up to one chunk per hardware thread (and
+// at least minChunkBytes each), every cut just past a newline. The first
+// offset is 0 and the last is text.size().
+inline std::vector<size_t> chunkCuts(std::string_view text, size_t minChunkBytes) {
+    size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunks = std::min(workers, std::max<size_t>(1, text.size() / minChunkBytes));
+
+    std::vector<size_t> cut{ 0 };
+    for (size_t c = 1; c < chunks; c++) {
+        size_t at = text.find('\n', std::max(cut.back(), text.size() * c / chunks));
+        if (at == std::string_view::npos) break;
+        cut.push_back(at + 1);
+    }
+    cut.push_back(text.size());
+    return cut;
+}
+
+// Calls parse(LineFields&, T&) for every line of text and returns the
+// records in file order. As with the old stream loaders, a malformed
+// line ends the table: it and everything after it are dropped, and
+// *complete (if given) is set to false.
+template <class T, class Parse>
+std::vector<T> parseLines(std::string_view text, Parse parse, bool* complete = nullptr,
+                          size_t minChunkBytes = 1 << 20) {
+    std::vector<size_t> cut = chunkCuts(text, minChunkBytes);
+
+    struct Part {
+        std::vector<T> rows;
+        bool complete = true;   // false once a malformed line was hit
+    };
+
+    auto parseChunk = [&](size_t c) {
+        Part part;
+        std::string_view chunk = text.substr(cut[c], cut[c + 1] - cut[c]);
+        while (!chunk.empty()) {
+            size_t nl = chunk.find('\n');
+            std::string_view line = chunk.substr(0, nl);
+            chunk.remove_prefix(nl == std::string_view::npos ? chunk.size() : nl + 1);
+
+            if (line.find_first_not_of(" \t\r") == std::string_view::npos) continue;
+
+            LineFields in(line);
+            T row;
+            if (!parse(in, row)) {
+                part.complete = false;
+                break;
+            }
+            part.rows.push_back(std::move(row));
+        }
+        return part;
+    };
+
+    std::vector<std::future<Part>> pending;
+    for (size_t c = 1; c + 1 < cut.size(); c++)
+        pending.push_back(std::async(std::launch::async, parseChunk, c));
+    Part first = parseChunk(0);
+
+    std::vector<T> out = std::move(first.rows);
+    bool whole = first.complete;
+    for (auto& f : pending) {
+        Part part = f.get();
+        if (!whole) continue;
+        out.insert(out.end(), std::make_move_iterator(part.rows.begin()),
+                   std::make_move_iterator(part.rows.end()));
+        whole = part.complete;
+    }
+    if (complete) *complete = whole;
+    return out;
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef DATE_H
+#define DATE_H
+
+#include <cstdio>
+#include <ctime>
+#include <string>
+
+// Calendar dates are stored as day numbers (days since 1970-01-01),
+// so stays are half-open ranges [checkIn, checkOut) of plain ints.
+
+inline int daysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const int yoe = y - era * 400;
+    const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+inline void civilFromDays(int z, int& y, int& m, int& d) {
+    z += 719468;
+    const int era = (z >= 0 ? z : z - 146096) / 146097;
+    const int doe = z - era * 146097;
+    const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp + (mp < 10 ? 3 : -9);
+    y = yoe + era * 400 + (m <= 2);
+}
+
+// Parses YYYY-MM-DD; returns false for malformed or impossible dates
+inline bool parseDate(const std::string& s, int& day) {
+    int y, m, d;
+    char tail;
+    if (std::sscanf(s.c_str(), "%4d-%2d-%2d%c", &y, &m, &d, &tail) != 3) return false;
+    if (m < 1 || m > 12 || d < 1 || d > 31) return false;
+
+    day = daysFromCivil(y, m, d);
+
+    int cy, cm, cd;
+    civilFromDays(day, cy, cm, cd);
+    return cy == y && cm == m && cd == d;
+}
+
+inline std::string formatDate(int day) {
+    int y, m, d;
+    civilFromDays(day, y, m, d);
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%04d-%02d-%02d", y, m, d);
+    return buf;
+}
+
+// Today's local date as a day number
+inline int today() {
+    std::time_t t = std::time(nullptr);
+    std::tm local;
+    localtime_r(&t, &local);
+    return daysFromCivil(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday);
+}
+
+#endif
@@ -0,0 +1,317 @@
+#include "Generations.h"
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+/* ================= Checksum ================= */
+
+namespace {
+
+const uint64_t P1 = 0x9E3779B185EBCA87ULL;
+const uint64_t P2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t P3 = 0x165667B19E3779F9ULL;
+
+inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// A single xxHash64-style lane: one multiply-rotate-multiply per word
+class Checksum {
+public:
+    // n must be a multiple of 8 until finish()
+    void words(const char* p, size_t n) {
+        for (size_t i = 0; i < n; i += 8) {
+            uint64_t w;
+            std::memcpy(&w, p + i, 8);
+            mix(w);
+        }
+    }
+
+    uint64_t finish(const char* tail, size_t n, uint64_t length) {
+        uint64_t w = 0;
+        std::memcpy(&w, tail, n);
+        mix(w);
+        h ^= length;
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P3;
+        h ^= h >> 32;
+        return h;
+    }
+
+private:
+    uint64_t h = P3;
+    void mix(uint64_t w) { h = rotl(h ^ (w * P2), 31) * P1; }
+};
+
+uint64_t checksumText(const std::string& s) {
+    Checksum c;
+    size_t whole = s.size() & ~(size_t)7;
+    c.words(s.data(), whole);
+    return c.finish(s.data() + whole, s.size() - whole, s.size());
+}
+
+std::string hex(uint64_t v) {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016" PRIx64, v);
+    return buf;
+}
+
+bool parseHex(const std::string& s, uint64_t& v) {
+    if (s.size() != 16) return false;
+    char* end;
+    v = std::strtoull(s.c_str(), &end, 16);
+    return *end == '\0';
+}
+
+// Fills buf unless the file ends first; returns the bytes read or -1
+ssize_t readFull(int fd, char* buf, size_t n) {
+    size_t got = 0;
+    while (got < n) {
+        ssize_t r = ::read(fd, buf + got, n - got);
+        if (r < 0) return -1;
+        if (r == 0) break;
+        got += (size_t)r;
+    }
+    return (ssize_t)got;
+}
+
+// fsync works on directories too, which makes renames and new
+// entries in them durable
+bool syncPath(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+bool writeFile(const std::string& path, const std::string& data) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    const char* p = data.data();
+    size_t left = data.size();
+    while (left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n <= 0) {
+            ::close(fd);
+            return false;
+        }
+        p += n;
+        left -= (size_t)n;
+    }
+    bool ok = ::fsync(fd) == 0;
+    return ::close(fd) == 0 && ok;
+}
+
+// gen-000042 -> 42; 0 for anything else
+uint64_t generationOf(const std::string& name) {
+    if (name.size() <= 4 || name.compare(0, 4, "gen-") != 0) return 0;
+    uint64_t g = 0;
+    for (size_t i = 4; i < name.size(); i++) {
+        if (name[i] < '0' || name[i] > '9') return 0;
+        g = g * 10 + (uint64_t)(name[i] - '0');
+    }
+    return g;
+}
+
+const char* const MANIFEST_MAGIC = "hotel-manifest 1";
+
+} // namespace
+
+bool GenerationStore::checksumFile(const std::string& path, uint64_t& size, uint64_t& sum) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    static constexpr size_t BUF = 1 << 20;
+    std::vector<char> buf(BUF);
+    Checksum c;
+    size = 0;
+    while (true) {
+        ssize_t n = readFull(fd, buf.data(), BUF);
+        if (n < 0) {
+            ::close(fd);
+            return false;
+        }
+        size += (uint64_t)n;
+        size_t whole = (size_t)n & ~(size_t)7;
+        c.words(buf.data(), whole);
+        if ((size_t)n < BUF) {
+            sum = c.finish(buf.data() + whole, (size_t)n - whole, size);
+            break;
+        }
+    }
+    ::close(fd);
+    return true;
+}
+
+/* ================= Generations ================= */
+
+GenerationStore::GenerationStore(std::string d) : dir(std::move(d)) {}
+
+std::string GenerationStore::genDir(uint64_t g) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "/gen-%06" PRIu64, g);
+    return dir + name;
+}
+
+std::string GenerationStore::path(const std::string& file) const {
+    return (gen ? genDir(gen) : dir) + "/" + file;
+}
+
+bool GenerationStore::verify(uint64_t g, std::vector<File>& out, std::string& why) const {
+    std::string base = genDir(g);
+    std::ifstream f(base + "/MANIFEST", std::ios::binary);
+    if (!f) {
+        why = "no MANIFEST (save interrupted)";
+        return false;
+    }
+    std::string text((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+    // The last line seals everything before it
+    size_t endLine = text.rfind("end ");
+    uint64_t sealed;
+    if (endLine == std::string::npos || (endLine > 0 && text[endLine - 1] != '\n') ||
+        text.empty() || text.back() != '\n' ||
+        !parseHex(text.substr(endLine + 4, text.size() - endLine - 5), sealed) ||
+        sealed != checksumText(text.substr(0, endLine))) {
+        why = "MANIFEST checksum mismatch";
+        return false;
+    }
+
+    std::istringstream in(text.substr(0, endLine));
+    std::string line, kind;
+    uint64_t listed = 0;
+    if (!std::getline(in, line) || line != MANIFEST_MAGIC ||
+        !(in >> kind >> listed) || kind != "generation" || listed != g) {
+        why = "bad MANIFEST header";
+        return false;
+    }
+
+    out.clear();
+    std::string sum;
+    while (in >> kind) {
+        File file;
+        if (kind != "file" || !(in >> file.name >> file.size >> sum) || !parseHex(sum, file.checksum)) {
+            why = "bad MANIFEST entry";
+            return false;
+        }
+        out.push_back(file);
+    }
+
+    for (const File& file : out) {
+        uint64_t size, checksum;
+        if (!checksumFile(base + "/" + file.name, size, checksum)) {
+            why = file.name + " is missing";
+            return false;
+        }
+        if (size != file.size || checksum != file.checksum) {
+            why = file.name + " does not match its checksum";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GenerationStore::recover() {
+    HOTEL_TIMED(Recover);
+    std::vector<uint64_t> found;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        uint64_t g = generationOf(entry.path().filename().string());
+        if (g > 0) found.push_back(g);
+    }
+    std::sort(found.rbegin(), found.rend());
+
+    gen = kept = 0;
+    unverified = false;
+    highest = found.empty() ? 0 : found.front();
+
+    std::vector<File> files;
+    for (uint64_t g : found) {
+        std::string why;
+        if (verify(g, files, why)) {
+            gen = kept = g;
+            if (g != highest) std::cerr << "Recovered " << genDir(g) << "\n";
+            return true;
+        }
+        std::cerr << "Skipping " << genDir(g) << ": " << why << "\n";
+        // One without a MANIFEST is a save that never committed
+        if (fs::exists(genDir(g) + "/MANIFEST", ec)) unverified = true;
+    }
+
+    if (!found.empty()) std::cerr << "No consistent generation in " << dir << "\n";
+    return false;
+}
+
+std::string GenerationStore::begin() {
+    if (damaged()) return "";
+    pending = std::max(highest, gen) + 1;
+    highest = pending;
+    std::string d = genDir(pending);
+
+    std::error_code ec;
+    fs::remove_all(d, ec);
+    if (!fs::create_directories(d, ec)) return "";
+    return d;
+}
+
+bool GenerationStore::commit(const std::vector<std::string>& names) {
+    HOTEL_TIMED(SealGeneration);
+    if (pending == 0) return false;
+    std::string base = genDir(pending);
+
+    std::string text = MANIFEST_MAGIC;
+    text += "\ngeneration " + std::to_string(pending) + "\n";
+
+    for (const std::string& name : names) {
+        File file{ name, 0, 0 };
+        std::string p = base + "/" + name;
+        if (!syncPath(p) || !checksumFile(p, file.size, file.checksum)) return false;
+        text += "file " + name + " " + std::to_string(file.size) + " " + hex(file.checksum) + "\n";
+    }
+    text += "end " + hex(checksumText(text)) + "\n";
+
+    // The rename is the commit point; the directory syncs make the
+    // table files' entries and then the MANIFEST itself durable
+    std::string tmp = base + "/MANIFEST.tmp";
+    if (!syncPath(base) || !writeFile(tmp, text) ||
+        std::rename(tmp.c_str(), (base + "/MANIFEST").c_str()) != 0)
+        return false;
+
+    kept = gen;
+    gen = pending;
+    pending = 0;
+
+    // Committed either way. If the rename is not durable yet, a crash
+    // recovers the fallback, which prune() keeps.
+    if (!syncPath(base) || !syncPath(dir))
+        std::cerr << "Committed " << base << ", but syncing its directory failed\n";
+    prune(kept);
+    return true;
+}
+
+// Keeps the current generation and the one it replaced
+void GenerationStore::prune(uint64_t previous) {
+    std::error_code ec;
+    std::vector<fs::path> stale;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        uint64_t g = generationOf(entry.path().filename().string());
+        if (g > 0 && g != gen && g != previous) stale.push_back(entry.path());
+    }
+    for (const auto& p : stale) fs::remove_all(p, ec);
+}
@@ -0,0 +1,82 @@
+#ifndef GENERATIONS_H
+#define GENERATIONS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Crash-safe storage for the table files. Every save writes a complete
+ * set of tables into a new directory, gen-NNNNNN, and commits it by
+ * renaming a MANIFEST into place that lists each file with its size and
+ * checksum; the manifest ends with a checksum of its own. Until that
+ * rename the previous generation is the current one, so a crash at any
+ * point during a save loses nothing that was committed.
+ *
+ *   hotel-manifest 1
+ *   generation 42
+ *   file rooms.dat 1234 9f86d081884c7d65
+ *   ...
+ *   end 2c26b46b68ffc68f
+ *
+ * recover() looks at the generations newest first and takes the first
+ * one whose manifest and files all verify. A commit keeps the generation
+ * it replaces as a fallback and removes the older ones along with any
+ * that were never committed. When committed generations exist but none
+ * of them verifies, the store is damaged: nothing is written or removed,
+ * so an operator can salvage what is left.
+ *
+ * Not thread-safe; Hotel calls it under persistMutex.
+ */
+class GenerationStore {
+public:
+    struct File {
+        std::string name;
+        uint64_t size;
+        uint64_t checksum;
+    };
+
+    explicit GenerationStore(std::string dir);
+
+    // Picks the newest consistent generation; false if there is none
+    // (a new directory, one written before generations existed, or a
+    // damaged one)
+    bool recover();
+    // Generations with a MANIFEST exist but none of them verified
+    bool damaged() const { return gen == 0 && unverified; }
+
+    // 0 until a generation is recovered or committed
+    uint64_t current() const { return gen; }
+    // The oldest generation still kept: the one the last commit
+    // replaced, or the current one before any commit
+    uint64_t fallback() const { return kept; }
+    // A table in the current generation, or in the directory itself
+    // when there is none
+    std::string path(const std::string& file) const;
+
+    // Creates the directory of the next generation and returns it
+    // (empty on failure, or when the store is damaged). The tables are
+    // written there, then commit() seals them and makes the generation
+    // current. Once the MANIFEST is renamed into place the generation is
+    // committed; a failed directory sync after that is reported but
+    // does not undo it.
+    std::string begin();
+    bool commit(const std::vector<std::string>& files);
+
+    // 64-bit checksum of a whole file, eight bytes at a time
+    static bool checksumFile(const std::string& path, uint64_t& size, uint64_t& sum);
+
+private:
+    std::string dir;
+    uint64_t gen = 0;
+    uint64_t highest = 0;   // newest generation seen on disk, valid or not
+    uint64_t pending = 0;   // started by begin(), not yet committed
+    uint64_t kept = 0;      // see fallback()
+    bool unverified = false; // recover() skipped a committed generation
+
+    std::string genDir(uint64_t g) const;
+    bool verify(uint64_t g, std::vector<File>& out, std::string& why) const;
+    void prune(uint64_t previous);
+};
+
+#endif
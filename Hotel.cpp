@@ -1,16 +1,87 @@
 #include "Hotel.h"
+#include "JsonWriter.h"
+#include "Metrics.h"
+#include "DatParser.h"
+#include "BulkIO.h"
 #include <sstream>
 #include <iomanip>
+#include <cinttypes>
+#include <filesystem>
+#include <stdexcept>
+#include <unordered_set>
+#include <cerrno>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* ================= Journal Records ================= */
+
+// Each journal entry is a sequence of full-record upserts, so replay
+// is idempotent and a checkpoint can crash at any point.
+
+static void logRoom(JournalEntry& e, const Room& r) {
+    e.add("R").add(r.roomId).add(r.typeId).add((int)r.status).add(r.customPrice);
+}
+
+static void logCustomer(JournalEntry& e, const Customer& c) {
+    e.add("C").add(c.custId).add(c.name).add(c.phone).add(c.email);
+}
+
+static void logBooking(JournalEntry& e, const Booking& b) {
+    e.add("BQ").add(b.bookingId).add(b.custId).add(b.roomId)
+     .add(b.roomTypeId).add(b.days).add((int)b.status).add(b.checkIn).add(b.amount);
+}
+
+static void logPayment(JournalEntry& e, const Payment& p) {
+    e.add("PD").add(p.paymentId).add(p.bookingId).add(p.baseAmount)
+     .add(p.extraCharges).add(p.taxRate).add(p.paidOn);
+}
+
+static void logMaintenance(JournalEntry& e, const Maintenance& m) {
+    e.add("MJ").add(m.maintId).add(m.roomId).add(m.issue)
+     .add((int)m.status).add(m.scheduledDate).add((int)m.priority)
+     .add(m.day).add(m.dueDay).add(m.staffId).add(m.completedOn);
+}
+
+// Set by commit() for the calling thread, like errno
+static thread_local bool unsavedChange = false;
+
+// "12,13,14", for traced ID lists
+static std::string joinIds(const std::vector<int>& ids) {
+    std::string out;
+    for (int id : ids) {
+        if (!out.empty()) out += ',';
+        out += std::to_string(id);
+    }
+    return out;
+}
+
+static void logStaff(JournalEntry& e, const Staff& s) {
+    e.add("S").add(s.staffId).add(s.name).add(s.role).add(s.salary);
+}
 
 /* ================= Constructor & Init ================= */
 
-Hotel::Hotel() {
+Hotel::Hotel(const std::string& dir)
+    : dataDir(dir), metricsProperty(metrics::boundProperty()), generations(dir.empty() ? "." : dir),
+      journal(journalSegment(0)), invoices(1024, dir.empty() ? "." : dir) {
+    if (!dataDir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(dataDir, ec);
+        if (ec) std::cerr << "Cannot create " << dataDir << ": " << ec.message() << "\n";
+    }
+
+    // The rate plan is optional; rate tables are built by loadAll
+    RatePlan plan;
+    if (loadRatePlan(dataPath("rates.conf"), plan)) rates.setPlan(std::move(plan));
+
     // Load saved data
     loadAll();
 
     // First run: no rooms & no room types
     if (rooms.empty() && roomTypes.empty()) {
         initDefaultData();
+        rebuildRates();      // loadAll built them before any type existed
         saveAll();
         return;
     }
@@ -19,13 +90,23 @@ Hotel::Hotel() {
     // so we must regenerate them if missing.
     if (roomTypes.empty()) {
         initDefaultData();   // This only adds room types due to updated function
-        saveAll();
+        rebuildStats();      // Booking estimates need the room type prices
+        rebuildRates();
     }
 }
 
+std::string Hotel::dataPath(const char* file) const {
+    return dataDir.empty() ? std::string(file) : dataDir + "/" + file;
+}
+
+std::string Hotel::tablePath(const char* file) const {
+    return generations.path(file);
+}
+
 /* ================= Default Data Setup ================= */
 
 void Hotel::initDefaultData() {
+    trace::Scope call(tracer, "initDefaultData");
     // Create Room Types only if none exist
     if (roomTypes.empty()) {
         addRoomType(RoomType(1, "Standard", 1500.0, "Basic amenities"));
@@ -41,262 +122,1117 @@ void Hotel::initDefaultData() {
     }
 
     // Add default staff only once
+    std::unique_lock<std::shared_mutex> lock(tableMutex);
     if (staff.empty()) {
         staff.push_back(Staff(1, "Admin User", "Administrator", 30000));
         staff.push_back(Staff(2, "Reception", "Staff", 15000));
+        staff.push_back(Staff(3, "Technician 1", "Technician", 18000));
+        staff.push_back(Staff(4, "Technician 2", "Technician", 18000));
+        nextStaffId = 5;
+        rebuildMaintenanceQueue();
     }
 }
 
 /* ================= Room / Customer Functions ================= */
 
 void Hotel::addRoomType(const RoomType& rt) {
+    trace::Scope call(tracer, "addRoomType", rt.typeId, rt.name, rt.basePrice, rt.features);
+    std::unique_lock<std::shared_mutex> lock(tableMutex);
+    roomTypeIndex.emplace(rt.typeId, roomTypes.size());
     roomTypes.push_back(rt);
 }
 
 const RoomType* Hotel::getRoomTypeById(int id) const {
-    for (const auto& t : roomTypes)
-        if (t.typeId == id) return &t;
-    return nullptr;
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    return roomTypeById(id);
+}
+
+const RoomType* Hotel::roomTypeById(int id) const {
+    auto it = roomTypeIndex.find(id);
+    return (it != roomTypeIndex.end()) ? &roomTypes[it->second] : nullptr;
 }
 
-void Hotel::addRoom(int typeId, double customPrice) {
+int Hotel::addRoom(int typeId, double customPrice) {
+    trace::Scope call(tracer, "addRoom", typeId, customPrice);
+    std::unique_lock<std::shared_mutex> lock(tableMutex);
+    roomIndex.emplace(nextRoomId, rooms.size());
     rooms.push_back(Room(nextRoomId++, typeId, customPrice));
+    roomVersions.push_back(rooms.back());
+    freePos.push_back(NOT_FREE);
+    poolInsert(rooms.size() - 1);
+    calendars.emplace_back();
+    roomsByType[typeId].push_back(rooms.size() - 1);
+    occupancy.setRooms(typeId, (int)roomsByType[typeId].size());
+    rates.roomsChanged(typeId, occupancy);
+    stats.roomStatus[(int)RoomStatus::Available]++;
+    return call.ret(rooms.back().roomId);
 }
 
 Room* Hotel::findRoom(int roomId) {
-    for (auto& r : rooms)
-        if (r.roomId == roomId) return &r;
-    return nullptr;
+    auto it = roomIndex.find(roomId);
+    return (it != roomIndex.end()) ? &rooms[it->second] : nullptr;
+}
+
+std::optional<Room> Hotel::getRoom(int roomId) const {
+    trace::Scope call(tracer, "getRoom", roomId);
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    auto it = roomIndex.find(roomId);
+    if (it == roomIndex.end()) return call.ret(std::optional<Room>());
+    return call.ret(std::make_optional(rooms[it->second]));
+}
+
+std::optional<Booking> Hotel::getBooking(int bookingId) const {
+    HOTEL_TIMED(GetBooking);
+    trace::Scope call(tracer, "getBooking", bookingId);
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    auto it = bookingIndex.find(bookingId);
+    if (it == bookingIndex.end()) return call.ret(std::optional<Booking>());
+    return call.ret(std::make_optional(bookings[it->second]));
+}
+
+int Hotel::roomOfBooking(int bookingId) const {
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    auto it = bookingIndex.find(bookingId);
+    return (it != bookingIndex.end()) ? bookings[it->second].roomId : -1;
 }
 
 bool Hotel::hasRoom(int roomId) const {
-    for (const auto& r : rooms)
-        if (r.roomId == roomId) return true;
-    return false;
+    trace::Scope call(tracer, "hasRoom", roomId);
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    return call.ret(roomIndex.count(roomId) != 0);
 }
 
 bool Hotel::hasCustomer(int custId) const {
-    for (const auto& c : customers)
-        if (c.custId == custId) return true;
-    return false;
+    trace::Scope call(tracer, "hasCustomer", custId);
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    return call.ret(customerIndex.count(custId) != 0);
 }
 
 bool Hotel::hasBooking(int bookingId) const {
-    for (const auto& b : bookings)
-        if (b.bookingId == bookingId) return true;
-    return false;
+    trace::Scope call(tracer, "hasBooking", bookingId);
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    return call.ret(bookingIndex.count(bookingId) != 0);
+}
+
+void Hotel::rebuildIndexes() {
+    roomTypeIndex.clear();
+    roomIndex.clear();
+    customerIndex.clear();
+    bookingIndex.clear();
+    paymentIndex.clear();
+    maintIndex.clear();
+
+    roomTypeIndex.reserve(roomTypes.size());
+    roomIndex.reserve(rooms.size());
+    customerIndex.reserve(customers.size());
+    bookingIndex.reserve(bookings.size());
+    paymentIndex.reserve(payments.size());
+    maintIndex.reserve(maintenanceLogs.size());
+
+    for (size_t i = 0; i < roomTypes.size(); i++) roomTypeIndex.emplace(roomTypes[i].typeId, i);
+    for (size_t i = 0; i < rooms.size(); i++) roomIndex.emplace(rooms[i].roomId, i);
+    for (size_t i = 0; i < customers.size(); i++) customerIndex.emplace(customers[i].custId, i);
+    for (size_t i = 0; i < bookings.size(); i++) bookingIndex.emplace(bookings[i].bookingId, i);
+    for (size_t i = 0; i < payments.size(); i++) paymentIndex.emplace(payments.paymentId[i], i);
+    for (size_t i = 0; i < maintenanceLogs.size(); i++) maintIndex.emplace(maintenanceLogs[i].maintId, i);
+
+    customerLookup.build(customers);
+}
+
+/* ================= Free Room Pools ================= */
+
+void Hotel::poolInsert(size_t slot) {
+    if (freePos[slot] != NOT_FREE) return;
+    auto& pool = freeRooms[rooms[slot].typeId];
+    freePos[slot] = pool.size();
+    pool.push_back(slot);
+}
+
+void Hotel::poolRemove(size_t slot) {
+    size_t pos = freePos[slot];
+    if (pos == NOT_FREE) return;
+
+    auto& pool = freeRooms[rooms[slot].typeId];
+    size_t last = pool.back();
+    pool[pos] = last;
+    freePos[last] = pos;
+    pool.pop_back();
+    freePos[slot] = NOT_FREE;
+}
+
+void Hotel::rebuildFreePools() {
+    freeRooms.clear();
+    freePos.assign(rooms.size(), NOT_FREE);
+
+    for (size_t i = 0; i < rooms.size(); i++)
+        if (rooms[i].status == RoomStatus::Available) poolInsert(i);
+}
+
+void Hotel::setRoomStatus(Room& r, RoomStatus s) {
+    size_t slot = (size_t)(&r - rooms.data());
+    stats.roomStatus[(int)r.status]--;
+    stats.roomStatus[(int)s]++;
+    r.status = s;
+    roomVersions.set(slot, r);
+
+    if (s == RoomStatus::Available) poolInsert(slot);
+    else poolRemove(slot);
+}
+
+/* ================= Aggregates ================= */
+
+double Hotel::bookingEstimate(const Booking& b) const {
+    if (b.amount > 0.0) return b.amount;
+    const RoomType* rt = roomTypeById(b.roomTypeId);
+    return rt ? rt->basePrice * b.days : 0.0;
+}
+
+void Hotel::setBookingStatus(Booking& b, BookingStatus s) {
+    if (b.status == BookingStatus::Confirmed) stats.estimatedActive -= bookingEstimate(b);
+    if (s == BookingStatus::Confirmed) stats.estimatedActive += bookingEstimate(b);
+
+    stats.bookingStatus[(int)b.status]--;
+    stats.bookingStatus[(int)s]++;
+    b.status = s;
+    bookingVersions.set((size_t)(&b - bookings.data()), b);
+}
+
+void Hotel::recordPayment(const Payment& p, int roomTypeId) {
+    double total = p.total();
+    stats.completedRevenue += total;
+    stats.typeRevenue[roomTypeId] += total;
+}
+
+void Hotel::rebuildStats() {
+    stats.clear();
+
+    for (const auto& r : rooms)
+        stats.roomStatus[(int)r.status]++;
+
+    for (const auto& b : bookings) {
+        stats.bookingStatus[(int)b.status]++;
+        if (b.status == BookingStatus::Confirmed) stats.estimatedActive += bookingEstimate(b);
+    }
+
+    rebuildPaymentStats();
+}
+
+void Hotel::rebuildPaymentStats() {
+    // Refresh the ledger's room type column, then aggregate with the
+    // columnar kernels
+    for (size_t i = 0; i < payments.size(); i++) {
+        auto it = bookingIndex.find(payments.bookingId[i]);
+        payments.roomTypeId[i] = (it != bookingIndex.end()) ? bookings[it->second].roomTypeId : 0;
+    }
+    stats.completedRevenue = payments.sumTotal();
+    stats.typeRevenue = payments.sumByRoomType();
+}
+
+void Hotel::rebuildOccupancy() {
+    occupancy.clear();
+    occupancy.beginRebuild();
+    for (const auto& t : roomsByType) occupancy.setRooms(t.first, (int)t.second.size());
+
+    // Bookings saved before dates existed have no nights to place
+    for (const auto& b : bookings) {
+        if (b.checkIn == 0) continue;
+        if (b.status == BookingStatus::Cancelled) occupancy.addCancellation(b.roomTypeId, b.checkIn);
+        else occupancy.addStay(b.roomTypeId, b.checkIn, b.days);
+    }
+    placePayments();
+    occupancy.endRebuild();
+    rebuildRates();
+}
+
+// Adds the ledger's payments to the occupancy days; the caller runs
+// beginRebuild() / endRebuild() around it
+void Hotel::placePayments() {
+    for (size_t i = 0; i < payments.size(); i++) {
+        auto it = bookingIndex.find(payments.bookingId[i]);
+        if (it == bookingIndex.end()) continue;
+        const Booking& b = bookings[it->second];
+        if (b.checkIn == 0) continue;
+        occupancy.addCheckout(b.roomTypeId, b.checkIn, b.days, payments.baseAmount[i],
+                              payments.total(i), payments.paidOn[i]);
+    }
+}
+
+/* ================= Rates ================= */
+
+// Tables start yesterday so stays checking in late at night still hit them
+void Hotel::rebuildRates() {
+    std::vector<int> typeIds;
+    typeIds.reserve(roomTypes.size());
+    for (const auto& rt : roomTypes) typeIds.push_back(rt.typeId);
+    rates.rebuild(typeIds, today() - 1, occupancy);
+}
+
+double Hotel::quoteRoom(const Room& r, int checkIn, int nights) const {
+    const RoomType* rt = roomTypeById(r.typeId);
+    if (!rt) return 0.0;
+    return rates.quote(r.typeId, r.effectivePrice(rt->basePrice), checkIn, nights, occupancy);
+}
+
+double Hotel::quoteStay(int roomId, int checkIn, int nights) const {
+    HOTEL_TIMED(Quote);
+    trace::Scope call(tracer, "quoteStay", roomId, checkIn, nights);
+    if (nights < 1) return call.ret(-1.0);
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    auto it = roomIndex.find(roomId);
+    if (it == roomIndex.end() || !roomTypeById(rooms[it->second].typeId)) return call.ret(-1.0);
+    return call.ret(quoteRoom(rooms[it->second], checkIn, nights));
+}
+
+double Hotel::quoteType(int typeId, int checkIn, int nights) const {
+    HOTEL_TIMED(Quote);
+    trace::Scope call(tracer, "quoteType", typeId, checkIn, nights);
+    if (nights < 1) return call.ret(-1.0);
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    const RoomType* rt = roomTypeById(typeId);
+    if (!rt) return call.ret(-1.0);
+    return call.ret(rates.quote(typeId, rt->basePrice, checkIn, nights, occupancy));
+}
+
+void Hotel::setRatePlan(const RatePlan& plan) {
+    trace::Scope call(tracer, "setRatePlan", tracer.active() ? formatRatePlan(plan) : std::string());
+    awaitLazyTables();
+    std::unique_lock<std::shared_mutex> lock(tableMutex);
+    rates.setPlan(plan);
+    rebuildRates();
+}
+
+/* ================= Versioned Tables ================= */
+
+void Hotel::rebuildVersions() {
+    roomVersions.assign(rooms, rooms.size());
+    customerVersions.assign(customers, customers.size());
+    bookingVersions.assign(bookings, bookings.size());
+}
+
+HotelView Hotel::pinView() const {
+    trace::Scope call(tracer, "pinView");
+    awaitLazyTables();
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    return HotelView{ roomVersions.view(), customerVersions.view(), bookingVersions.view(),
+                      payments.size(), roomTypes, stats };
+}
+
+/* ================= Availability Calendar ================= */
+
+void Hotel::rebuildCalendars() {
+    calendars.assign(rooms.size(), RoomCalendar());
+    roomsByType.clear();
+    for (size_t i = 0; i < rooms.size(); i++)
+        roomsByType[rooms[i].typeId].push_back(i);
+
+    int now = today();
+    for (auto& b : bookings) {
+        if (b.status != BookingStatus::Confirmed) continue;
+
+        // Bookings saved before dates existed are taken as starting today
+        if (b.checkIn == 0) b.checkIn = now;
+
+        auto it = roomIndex.find(b.roomId);
+        if (it == roomIndex.end()) continue;
+        if (!calendars[it->second].reserve(b.checkIn, b.checkOut(), b.bookingId))
+            std::cerr << "Booking " << b.bookingId << " overlaps another stay in room " << b.roomId << "\n";
+    }
+
+    // Reservations whose stay has started since the last run
+    for (size_t i = 0; i < rooms.size(); i++)
+        if (rooms[i].status == RoomStatus::Available && calendars[i].occupant(now) >= 0)
+            rooms[i].status = RoomStatus::Booked;
+    statusDay.store(now, std::memory_order_release);
+}
+
+// Booked is derived from the calendars (loading resets it), so the
+// rollover only changes memory and needs no journal record
+void Hotel::rollOverDay() {
+    int now = today();
+    if (statusDay.load(std::memory_order_acquire) == now) return;
+
+    std::unique_lock<std::shared_mutex> lock(tableMutex);
+    if (statusDay.load(std::memory_order_relaxed) == now) return;
+    for (size_t i = 0; i < rooms.size(); i++)
+        if (rooms[i].status == RoomStatus::Available && calendars[i].occupant(now) >= 0)
+            setRoomStatus(rooms[i], RoomStatus::Booked);
+    statusDay.store(now, std::memory_order_release);
+}
+
+// After a stay ends early, the room is Booked if another reservation
+// already covers today and Available otherwise
+void Hotel::settleRoomStatus(Room& r) {
+    if (r.status == RoomStatus::Maintenance) return;
+
+    size_t slot = (size_t)(&r - rooms.data());
+    bool occupied = calendars[slot].occupant(today()) >= 0;
+    setRoomStatus(r, occupied ? RoomStatus::Booked : RoomStatus::Available);
+}
+
+// A stay reserved for the day, or for today a guest still in the room
+// (a stay lasts until checkout, even past its dates)
+bool Hotel::roomTaken(const Room& r, int day) const {
+    size_t slot = (size_t)(&r - rooms.data());
+    if (calendars[slot].occupant(day) >= 0) return true;
+    return day <= today() && r.status == RoomStatus::Booked;
+}
+
+std::vector<int> Hotel::findAvailableRooms(int typeId, int from, int to) const {
+    HOTEL_TIMED(FindAvailableRooms);
+    trace::Scope call(tracer, "findAvailableRooms", typeId, from, to);
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    std::vector<int> result;
+
+    auto it = roomsByType.find(typeId);
+    if (it == roomsByType.end() || from >= to) return call.ret(std::move(result));
+
+    for (size_t slot : it->second)
+        if (calendars[slot].isFree(from, to)) result.push_back(rooms[slot].roomId);
+    return call.ret(std::move(result));
+}
+
+size_t Hotel::freeRoomCount(int typeId) const {
+    trace::Scope call(tracer, "freeRoomCount", typeId);
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    auto it = freeRooms.find(typeId);
+    return call.ret((it != freeRooms.end()) ? it->second.size() : 0);
 }
 
 int Hotel::addCustomer(const std::string& name, const std::string& phone, const std::string& email) {
-    customers.emplace_back(nextCustomerId, name, phone, email);
-    int id = nextCustomerId++;
-    saveAll();
-    return id;
+    HOTEL_TIMED(AddCustomer);
+    trace::Scope call(tracer, "addCustomer", name, phone, email);
+    JournalEntry e;
+    int id;
+    {
+        std::unique_lock<std::shared_mutex> lock(tableMutex);
+        if (dedupCustomers) {
+            std::vector<size_t> same = customerLookup.byEmail(email);
+            if (same.empty()) same = customerLookup.byPhone(phone);
+            if (!same.empty()) return call.ret(customers[same.front()].custId);
+        }
+
+        customerIndex.emplace(nextCustomerId, customers.size());
+        customers.emplace_back(nextCustomerId, strings.store(name), strings.store(phone),
+                               strings.store(email));
+        customerLookup.add(customers.back(), customers.size() - 1);
+        customerVersions.push_back(customers.back());
+        id = nextCustomerId++;
+        logCustomer(e, customers.back());
+    }
+
+    if (!commit(e)) return call.ret(-3);
+    return call.ret(id);
+}
+
+void Hotel::setCustomerDedup(bool on) {
+    trace::Scope call(tracer, "setCustomerDedup", (int)on);
+    std::unique_lock<std::shared_mutex> lock(tableMutex);
+    dedupCustomers = on;
+}
+
+std::vector<Customer> Hotel::findCustomers(const CustomerQuery& q) const {
+    HOTEL_TIMED(FindCustomers);
+    trace::Scope call(tracer, "findCustomers", q.phone, q.email, q.namePrefix, (int)q.limit);
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    std::vector<Customer> out;
+
+    // Start from the most selective index and filter on the rest
+    std::vector<size_t> slots;
+    if (!q.email.empty()) slots = customerLookup.byEmail(q.email);
+    else if (!q.phone.empty()) slots = customerLookup.byPhone(q.phone);
+    else if (!q.namePrefix.empty()) slots = customerLookup.byNamePrefix(q.namePrefix, q.limit);
+    else return call.ret(std::move(out));
+
+    for (size_t slot : slots) {
+        if (out.size() >= q.limit) break;
+        const Customer& c = customers[slot];
+        if (!q.phone.empty() && !CustomerIndex::samePhone(c.phone, q.phone)) continue;
+        if (!q.namePrefix.empty() && !CustomerIndex::hasNamePrefix(c.name, q.namePrefix)) continue;
+        out.push_back(c);
+    }
+    return call.ret(std::move(out));
 }
 
 int Hotel::createBooking(int custId, int roomId, int days) {
-    Room* r = findRoom(roomId);
-    if (!r) return -1;
-    if (r->status != RoomStatus::Available) return -2;
+    HOTEL_TIMED(CreateBooking);
+    trace::Scope call(tracer, "createBooking", custId, roomId, days);
+    return call.ret(createReservation(custId, roomId, today(), days));
+}
+
+int Hotel::createReservation(int custId, int roomId, int checkIn, int nights) {
+    HOTEL_TIMED(CreateReservation);
+    trace::Scope call(tracer, "createReservation", custId, roomId, checkIn, nights);
+    if (nights < 1) return call.ret(-1);
+    rollOverDay();
+
+    std::lock_guard<std::mutex> stripe(roomStripe(roomId));
+    JournalEntry e;
+    int bid;
+    {
+        std::unique_lock<std::shared_mutex> lock(tableMutex);
+        Room* r = findRoom(roomId);
+        if (!r) return call.ret(-1);
+
+        int now = today();
+        int checkOut = checkIn + nights;
+        if (checkOut <= now) return call.ret(-1);
+
+        // A stay that covers today also needs the room physically free
+        bool current = checkIn <= now;
+        if (current && r->status != RoomStatus::Available) return call.ret(-2);
+
+        size_t slot = (size_t)(r - rooms.data());
+        if (!calendars[slot].reserve(checkIn, checkOut, nextBookingId)) return call.ret(-2);
+
+        if (current) setRoomStatus(*r, RoomStatus::Booked);
+        bookingIndex.emplace(nextBookingId, bookings.size());
+        bookings.emplace_back(nextBookingId, custId, roomId, r->typeId, nights, checkIn);
+        // Priced at the occupancy before this stay is counted
+        bookings.back().amount = quoteRoom(*r, checkIn, nights);
+        bookingVersions.push_back(bookings.back());
+        occupancy.addStay(r->typeId, checkIn, nights);
+        rates.refresh(r->typeId, checkIn, nights, occupancy);
+        bid = nextBookingId++;
+        stats.bookingStatus[(int)BookingStatus::Confirmed]++;
+        stats.estimatedActive += bookingEstimate(bookings.back());
+
+        logRoom(e, *r);
+        logBooking(e, bookings.back());
+    }
 
-    r->status = RoomStatus::Booked;
-    bookings.emplace_back(nextBookingId, custId, roomId, r->typeId, days);
-    int bid = nextBookingId++;
-    saveAll();
-    return bid;
+    if (!commit(e)) return call.ret(-3);
+    return call.ret(bid);
+}
+
+int Hotel::bookAnyRoom(int custId, int typeId, int days) {
+    HOTEL_TIMED(BookAnyRoom);
+    trace::Scope call(tracer, "bookAnyRoom", custId, typeId, days);
+    rollOverDay();
+    while (true) {
+        int roomId;
+        {
+            std::shared_lock<std::shared_mutex> lock(tableMutex);
+            if (!roomTypeById(typeId)) return call.ret(-1);
+
+            auto it = freeRooms.find(typeId);
+            if (it == freeRooms.end() || it->second.empty()) return call.ret(-2);
+
+            // Free rooms may still hold a reservation starting soon;
+            // take the first one whose calendar is clear for the stay
+            int now = today();
+            roomId = -1;
+            for (auto slot = it->second.rbegin(); slot != it->second.rend(); ++slot) {
+                if (calendars[*slot].isFree(now, now + days)) {
+                    roomId = rooms[*slot].roomId;
+                    break;
+                }
+            }
+            if (roomId < 0) return call.ret(-2);
+        }
+
+        // Another desk may take the room first; then try the next one
+        int bid = createBooking(custId, roomId, days);
+        if (bid != -2) return call.ret(bid);
+    }
 }
 
 bool Hotel::cancelBooking(int bookingId) {
-    Booking* b = findBooking(bookingId);
-    if (!b) return false;
-    b->status = BookingStatus::Cancelled;
+    HOTEL_TIMED(CancelBooking);
+    trace::Scope call(tracer, "cancelBooking", bookingId);
+    int roomId = roomOfBooking(bookingId);
+    if (roomId < 0) return call.ret(false);
+
+    std::lock_guard<std::mutex> stripe(roomStripe(roomId));
+    JournalEntry e;
+    {
+        std::unique_lock<std::shared_mutex> lock(tableMutex);
+        Booking* b = findBooking(bookingId);
+        if (!b || b->status != BookingStatus::Confirmed) return call.ret(false);
+        setBookingStatus(*b, BookingStatus::Cancelled);
+        occupancy.removeStay(b->roomTypeId, b->checkIn, b->days);
+        occupancy.addCancellation(b->roomTypeId, b->checkIn);
+        rates.refresh(b->roomTypeId, b->checkIn, b->days, occupancy);
+
+        Room* r = findRoom(b->roomId);
+        if (r) {
+            calendars[(size_t)(r - rooms.data())].release(b->checkIn, bookingId);
+            if (r->status == RoomStatus::Booked) settleRoomStatus(*r);
+        }
 
-    Room* r = findRoom(b->roomId);
-    if (r) r->status = RoomStatus::Available;
+        logBooking(e, *b);
+        if (r) logRoom(e, *r);
+    }
 
-    saveAll();
-    return true;
+    return call.ret(commit(e));
 }
 
 Booking* Hotel::findBooking(int bookingId) {
-    for (auto& b : bookings)
-        if (b.bookingId == bookingId) return &b;
-    return nullptr;
+    auto it = bookingIndex.find(bookingId);
+    return (it != bookingIndex.end()) ? &bookings[it->second] : nullptr;
 }
 
 /* ================= Checkout ================= */
 
-void Hotel::checkoutBooking(int bookingId, double extraCharges) {
-    Booking* b = findBooking(bookingId);
-    if (!b) {
+bool Hotel::checkoutBooking(int bookingId, double extraCharges) {
+    HOTEL_TIMED(CheckoutBooking);
+    trace::Scope call(tracer, "checkoutBooking", bookingId, extraCharges);
+    awaitLazyTables();
+    int roomId = roomOfBooking(bookingId);
+    if (roomId < 0) {
         std::cerr << "No booking found with ID " << bookingId << "\n";
-        return;
+        return call.ret(false);
     }
 
-    Room* r = findRoom(b->roomId);
-    if (!r) {
-        std::cerr << "Room not found for booking.\n";
-        return;
-    }
+    std::lock_guard<std::mutex> stripe(roomStripe(roomId));
+    JournalEntry e;
+    Booking booking;
+    Payment payment;
+    {
+        std::unique_lock<std::shared_mutex> lock(tableMutex);
+        Booking* b = findBooking(bookingId);
+        if (!b) {
+            std::cerr << "No booking found with ID " << bookingId << "\n";
+            return call.ret(false);
+        }
 
-    const RoomType* rt = getRoomTypeById(b->roomTypeId);
-    if (!rt) {
-        std::cerr << "Room type not found for booking.\n";
-        return;
+        if (b->status != BookingStatus::Confirmed) {
+            std::cerr << "Booking " << bookingId << " is not active.\n";
+            return call.ret(false);
+        }
+
+        Room* r = findRoom(b->roomId);
+        if (!r) {
+            std::cerr << "Room not found for booking.\n";
+            return call.ret(false);
+        }
+
+        const RoomType* rt = roomTypeById(b->roomTypeId);
+        if (!rt) {
+            std::cerr << "Room type not found for booking.\n";
+            return call.ret(false);
+        }
+
+        // The rate quoted at booking; older bookings pay the base price
+        double base = (b->amount > 0.0) ? b->amount : rt->basePrice * b->days;
+
+        payment = Payment(nextPaymentId++, bookingId, base, extraCharges, TAX_RATE, today());
+        paymentIndex.emplace(payment.paymentId, payments.size());
+        payments.push_back(payment, b->roomTypeId);
+        recordPayment(payment, b->roomTypeId);
+        occupancy.addCheckout(b->roomTypeId, b->checkIn, b->days, base, payment.total(), payment.paidOn);
+
+        setBookingStatus(*b, BookingStatus::CheckedOut);
+        calendars[(size_t)(r - rooms.data())].release(b->checkIn, bookingId);
+        settleRoomStatus(*r);
+
+        logPayment(e, payment);
+        logBooking(e, *b);
+        logRoom(e, *r);
+
+        booking = *b;
     }
 
-    double base = rt->basePrice * b->days;
+    bool saved = commit(e);
 
-    payments.emplace_back(nextPaymentId, bookingId, base, extraCharges, TAX_RATE);
-    nextPaymentId++;
+    // The guest does not wait for the invoice file
+    invoices.push({ booking, payment });
+    return call.ret(saved);
+}
 
-    b->status = BookingStatus::CheckedOut;
-    r->status = RoomStatus::Available;
+void Hotel::flushInvoices() {
+    trace::Scope call(tracer, "flushInvoices");
+    invoices.flush();
+}
 
-    saveAll();
+size_t Hotel::writeInvoices(const std::vector<int>& bookingIds, const std::string& dir) {
+    trace::Scope call(tracer, "writeInvoices", tracer.active() ? joinIds(bookingIds) : std::string(), dir);
+    awaitLazyTables();
+    std::vector<InvoiceJob> jobs;
+    {
+        std::shared_lock<std::shared_mutex> lock(tableMutex);
+        std::unordered_map<int, size_t> wanted;   // bookingId -> booking slot
+        for (int id : bookingIds) {
+            auto it = bookingIndex.find(id);
+            if (it != bookingIndex.end() && bookings[it->second].status == BookingStatus::CheckedOut)
+                wanted.emplace(id, it->second);
+        }
 
-    // Generate invoice file
-    std::stringstream ss;
-    ss << "invoice_booking_" << bookingId << ".txt";
-    std::ofstream f(ss.str());
+        for (size_t i = 0; i < payments.size() && jobs.size() < wanted.size(); i++) {
+            auto it = wanted.find(payments.bookingId[i]);
+            if (it != wanted.end()) jobs.push_back({ bookings[it->second], payments[i] });
+        }
+    }
+    return call.ret(writeInvoiceBatch(std::move(jobs), dir));
+}
 
-    if (f) {
-        f << "Hotel Blue Whale - Invoice\n";
-        f << "Booking ID: " << bookingId << "\n";
-        f << "Customer ID: " << b->custId << "\n";
-        f << "Room ID: " << b->roomId << "\n";
-        f << "Days: " << b->days << "\n";
-        f << "Base: " << base << "\n";
-        f << "Extra: " << extraCharges << "\n";
-        f << "GST: " << payments.back().calculateTax() << "\n";
-        f << "Total: " << payments.back().total() << "\n";
+size_t Hotel::writeInvoicesForDay(int day, const std::string& dir) {
+    trace::Scope call(tracer, "writeInvoicesForDay", day, dir);
+    awaitLazyTables();
+    std::vector<InvoiceJob> jobs;
+    {
+        std::shared_lock<std::shared_mutex> lock(tableMutex);
+        for (size_t i = 0; i < payments.size(); i++) {
+            if (payments.paidOn[i] != day) continue;
+            auto it = bookingIndex.find(payments.bookingId[i]);
+            if (it != bookingIndex.end()) jobs.push_back({ bookings[it->second], payments[i] });
+        }
     }
+    return call.ret(writeInvoiceBatch(std::move(jobs), dir));
 }
 
 /* ================= Maintenance ================= */
 
-void Hotel::scheduleMaintenance(int roomId, const std::string& issue, const std::string& date) {
-    Room* r = findRoom(roomId);
-    if (!r) return;
+int Hotel::scheduleMaintenance(int roomId, const std::string& issue, const std::string& date,
+                               MaintPriority priority) {
+    HOTEL_TIMED(ScheduleMaintenance);
+    trace::Scope call(tracer, "scheduleMaintenance", roomId, issue, date, (int)priority);
+    int day;
+    if (!parseDate(date, day)) return call.ret(-1);
 
-    if (r->status == RoomStatus::Booked) {
-        std::cout << "Cannot schedule maintenance. Room is booked.\n";
-        return;
+    awaitLazyTables();
+    rollOverDay();
+    int id;
+    {
+        std::lock_guard<std::mutex> stripe(roomStripe(roomId));
+        JournalEntry e;
+        {
+            std::unique_lock<std::shared_mutex> lock(tableMutex);
+            Room* r = findRoom(roomId);
+            if (!r) return call.ret(-1);
+
+            // Work due now takes the room out of service straight away
+            int now = today();
+            bool due = day <= now;
+            if (roomTaken(*r, due ? now : day)) return call.ret(-2);
+            if (due) {
+                if (r->status != RoomStatus::Maintenance) setRoomStatus(*r, RoomStatus::Maintenance);
+                maintQueue.hold(roomId);
+                logRoom(e, *r);
+            }
+
+            Maintenance m(nextMaintId++, roomId, strings.intern(issue), strings.intern(date));
+            m.day = day;
+            m.priority = priority;
+            m.dueDay = day + slaDays(priority);
+            maintIndex.emplace(m.maintId, maintenanceLogs.size());
+            maintenanceLogs.push_back(m);
+            maintQueue.push({ m.maintId, roomId, (int)priority, day, m.dueDay, due });
+            id = m.maintId;
+
+            logMaintenance(e, m);
+        }
+        if (!commit(e)) id = -3;
     }
 
-    r->status = RoomStatus::Maintenance;
-    maintenanceLogs.emplace_back(nextMaintId++, roomId, issue, date);
-    saveAll();
+    dispatchMaintenance();
+    return call.ret(id);
 }
 
-void Hotel::toggleRoomMaintenance(int roomId) {
-    Room* r = findRoom(roomId);
-    if (!r) return;
+int Hotel::dispatchMaintenance() {
+    HOTEL_TIMED(DispatchMaintenance);
+    trace::Scope call(tracer, "dispatchMaintenance");
+    awaitLazyTables();
+    rollOverDay();
+    int started = 0, now = today();
+    bool saved = true;
+    std::vector<MaintenanceQueue::Job> occupied;   // a guest is still in the room
+
+    while (true) {
+        MaintenanceQueue::Job job;
+        int staffId = 0;
+        {
+            std::unique_lock<std::shared_mutex> lock(tableMutex);
+            if (maintQueue.idleTechnicians() == 0 || !maintQueue.popReady(now, job)) break;
+            maintQueue.takeTechnician(staffId);
+        }
 
-    if (r->status == RoomStatus::Maintenance) {
-        r->status = RoomStatus::Available;
-    } else if (r->status == RoomStatus::Available) {
-        r->status = RoomStatus::Maintenance;
-    } else {
-        std::cout << "Cannot change maintenance status. Room is currently booked.\n";
+        // The job and the technician are ours now; starting it changes
+        // the room, so it takes the room's stripe first like any other
+        // room transition
+        std::lock_guard<std::mutex> stripe(roomStripe(job.roomId));
+        JournalEntry e;
+        {
+            std::unique_lock<std::shared_mutex> lock(tableMutex);
+            Room* r = findRoom(job.roomId);
+            auto it = maintIndex.find(job.maintId);
+            if (!r || it == maintIndex.end() || roomTaken(*r, now)) {
+                maintQueue.returnTechnician(staffId);
+                if (r && it != maintIndex.end()) occupied.push_back(job);
+                continue;
+            }
+
+            if (!job.holding) maintQueue.hold(job.roomId);
+            if (r->status != RoomStatus::Maintenance) {
+                setRoomStatus(*r, RoomStatus::Maintenance);
+                logRoom(e, *r);
+            }
+
+            Maintenance& m = maintenanceLogs[it->second];
+            m.status = MaintStatus::InProgress;
+            m.staffId = staffId;
+            logMaintenance(e, m);
+        }
+        if (!commit(e)) saved = false;
+        started++;
+    }
+
+    if (!occupied.empty()) {
+        std::unique_lock<std::shared_mutex> lock(tableMutex);
+        for (const auto& job : occupied) maintQueue.push(job);
+    }
+    if (!saved) {
+        unsavedChange = true;   // a later start may have reset it
+        return call.ret(-3);
+    }
+    return call.ret(started);
+}
+
+bool Hotel::completeMaintenance(int maintId) {
+    HOTEL_TIMED(CompleteMaintenance);
+    trace::Scope call(tracer, "completeMaintenance", maintId);
+    awaitLazyTables();
+    int roomId;
+    bool saved;
+    {
+        std::shared_lock<std::shared_mutex> lock(tableMutex);
+        auto it = maintIndex.find(maintId);
+        if (it == maintIndex.end()) return call.ret(false);
+        roomId = maintenanceLogs[it->second].roomId;
+    }
+
+    {
+        std::lock_guard<std::mutex> stripe(roomStripe(roomId));
+        JournalEntry e;
+        {
+            std::unique_lock<std::shared_mutex> lock(tableMutex);
+            Maintenance& m = maintenanceLogs[maintIndex.find(maintId)->second];
+            if (m.status != MaintStatus::InProgress) return call.ret(false);
+            m.status = MaintStatus::Completed;
+            m.completedOn = today();
+            maintQueue.addTechnician(m.staffId);
+            logMaintenance(e, m);
+
+            Room* r = findRoom(roomId);
+            if (maintQueue.release(roomId) == 0 && r && r->status == RoomStatus::Maintenance) {
+                // A stay may have started while the room was out
+                setRoomStatus(*r, RoomStatus::Available);
+                settleRoomStatus(*r);
+                logRoom(e, *r);
+            }
+        }
+        saved = commit(e);
+    }
+
+    dispatchMaintenance();
+    return call.ret(saved);
+}
+
+std::vector<Maintenance> Hotel::openMaintenance() const {
+    trace::Scope call(tracer, "openMaintenance");
+    awaitLazyTables();
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    std::vector<Maintenance> out;
+    for (const auto& m : maintenanceLogs)
+        if (m.status != MaintStatus::Completed) out.push_back(m);
+
+    std::sort(out.begin(), out.end(), [](const Maintenance& a, const Maintenance& b) {
+        if (a.priority != b.priority) return a.priority < b.priority;
+        if (a.dueDay != b.dueDay) return a.dueDay < b.dueDay;
+        return a.maintId < b.maintId;
+    });
+    return call.ret(std::move(out));
+}
+
+// Jobs that took their room out of service before a restart keep
+// holding it; technicians on a job stay busy
+void Hotel::rebuildMaintenanceQueue() {
+    maintQueue.clear();
+    int now = today();
+    std::unordered_set<int> busy;
+
+    for (const auto& m : maintenanceLogs) {
+        if (m.status == MaintStatus::Completed) continue;
+        if (m.status == MaintStatus::InProgress) {
+            busy.insert(m.staffId);
+            maintQueue.hold(m.roomId);
+            continue;
+        }
+        Room* r = findRoom(m.roomId);
+        bool holding = m.day <= now && r && r->status == RoomStatus::Maintenance;
+        if (holding) maintQueue.hold(m.roomId);
+        maintQueue.push({ m.maintId, m.roomId, (int)m.priority, m.day, m.dueDay, holding });
+    }
+
+    for (const auto& s : staff)
+        if (s.isTechnician() && !busy.count(s.staffId))
+            maintQueue.addTechnician(s.staffId);
+}
+
+int Hotel::toggleRoomMaintenance(int roomId) {
+    HOTEL_TIMED(ToggleMaintenance);
+    trace::Scope call(tracer, "toggleRoomMaintenance", roomId);
+    awaitLazyTables();
+    rollOverDay();
+    std::lock_guard<std::mutex> stripe(roomStripe(roomId));
+    JournalEntry e;
+    int result;
+    {
+        std::unique_lock<std::shared_mutex> lock(tableMutex);
+        Room* r = findRoom(roomId);
+        if (!r) return call.ret(-1);
+
+        if (r->status == RoomStatus::Maintenance) {
+            // The queue's jobs put the room back when the last completes
+            if (maintQueue.holding(roomId)) return call.ret(-4);
+            setRoomStatus(*r, RoomStatus::Available);
+            settleRoomStatus(*r);
+            result = 0;
+        } else if (!roomTaken(*r, today())) {
+            setRoomStatus(*r, RoomStatus::Maintenance);
+            result = 1;
+        } else {
+            return call.ret(-2);
+        }
+
+        logRoom(e, *r);
+    }
+
+    return call.ret(commit(e) ? result : -3);
+}
+
+/* ================= Staff ================= */
+
+int Hotel::addStaff(const std::string& name, const std::string& role, double salary) {
+    trace::Scope call(tracer, "addStaff", name, role, salary);
+    // staff.dat keeps the role as one word
+    std::string oneWord = role;
+    std::replace(oneWord.begin(), oneWord.end(), ' ', '_');
+
+    JournalEntry e;
+    int id;
+    {
+        std::unique_lock<std::shared_mutex> lock(tableMutex);
+        staff.push_back(Staff(nextStaffId++, name, oneWord, salary));
+        id = staff.back().staffId;
+        if (staff.back().isTechnician()) maintQueue.addTechnician(id);
+        logStaff(e, staff.back());
     }
+    if (!commit(e)) id = -3;
+
+    dispatchMaintenance();
+    return call.ret(id);
+}
 
-    saveAll();
+std::vector<Staff> Hotel::getStaff() const {
+    trace::Scope call(tracer, "getStaff");
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    return call.ret(staff);
 }
 
 /* ================= Reporting Counts ================= */
 
 int Hotel::countAvailableRooms() const {
-    return std::count_if(rooms.begin(), rooms.end(),
-                         [](const Room& r){ return r.status == RoomStatus::Available; });
+    trace::Scope call(tracer, "countAvailableRooms");
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    return call.ret(stats.rooms(RoomStatus::Available));
 }
 
 int Hotel::countBookedRooms() const {
-    return std::count_if(rooms.begin(), rooms.end(),
-                         [](const Room& r){ return r.status == RoomStatus::Booked; });
+    trace::Scope call(tracer, "countBookedRooms");
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    return call.ret(stats.rooms(RoomStatus::Booked));
 }
 
 int Hotel::countMaintenanceRooms() const {
-    return std::count_if(rooms.begin(), rooms.end(),
-                         [](const Room& r){ return r.status == RoomStatus::Maintenance; });
+    trace::Scope call(tracer, "countMaintenanceRooms");
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    return call.ret(stats.rooms(RoomStatus::Maintenance));
 }
 
 double Hotel::estimatedRevenueActive() const {
-    double total = 0;
+    trace::Scope call(tracer, "estimatedRevenueActive");
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    return call.ret(stats.estimatedActive);
+}
 
-    for (const auto& b : bookings) {
-        if (b.status == BookingStatus::Confirmed) {
-            const RoomType* rt = getRoomTypeById(b.roomTypeId);
-            if (rt) total += rt->basePrice * b.days;
-        }
-    }
+double Hotel::completedRevenue() const {
+    trace::Scope call(tracer, "completedRevenue");
+    awaitLazyTables();
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    return call.ret(stats.completedRevenue);
+}
+
+std::vector<std::pair<int, double>> Hotel::revenueByMonth(int from, int to) const {
+    trace::Scope call(tracer, "revenueByMonth", from, to);
+    awaitLazyTables();
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    return call.ret(payments.sumByMonth(from, to));
+}
+
+std::vector<OccupancyPoint> Hotel::occupancySeries(int typeId, int from, int to,
+                                                   Resolution step) const {
+    HOTEL_TIMED(OccupancyQuery);
+    trace::Scope call(tracer, "occupancySeries", typeId, from, to, (int)step);
+    return call.ret(readOccupancySeries(typeId, from, to, step));
+}
 
-    return total;
+OccupancyPoint Hotel::occupancyTotal(int typeId, int from, int to) const {
+    HOTEL_TIMED(OccupancyQuery);
+    trace::Scope call(tracer, "occupancyTotal", typeId, from, to);
+    return call.ret(readOccupancyTotal(typeId, from, to));
+}
+
+// The dashboard and the occupancy report read the series through these,
+// so that a traced report is one record rather than one per query
+std::vector<OccupancyPoint> Hotel::readOccupancySeries(int typeId, int from, int to,
+                                                       Resolution step) const {
+    awaitLazyTables();
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    return occupancy.series(typeId, from, to, step);
+}
+
+OccupancyPoint Hotel::readOccupancyTotal(int typeId, int from, int to) const {
+    awaitLazyTables();
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    return occupancy.total(typeId, from, to);
 }
 
 /* ================= Persistence ================= */
 
-void Hotel::saveRooms() {
-    std::ofstream f("rooms.dat");
+bool Hotel::saveRooms(const std::string& path) {
+    HOTEL_TIMED(SaveRooms);
+    std::ofstream f(path);
     for (const auto& r : rooms) {
         f << r.roomId << " " << r.typeId << " " << (int)r.status << " " << r.customPrice << "\n";
     }
+    if (f) HOTEL_BYTES(SaveRooms, f.tellp());
+    f.close();
+    return !f.fail();
 }
 
-void Hotel::saveCustomers() {
-    std::ofstream f("customers.dat");
+bool Hotel::saveCustomers(const std::string& path) {
+    HOTEL_TIMED(SaveCustomers);
+    std::ofstream f(path);
     for (const auto& c : customers) {
         f << c.custId << " " << c.name << " " << c.phone << " " << c.email << "\n";
     }
+    if (f) HOTEL_BYTES(SaveCustomers, f.tellp());
+    f.close();
+    return !f.fail();
 }
 
-void Hotel::saveBookings() {
-    std::ofstream f("bookings.dat");
+bool Hotel::saveBookings(const std::string& path) {
+    HOTEL_TIMED(SaveBookings);
+    std::ofstream f(path);
     for (const auto& b : bookings) {
         f << b.bookingId << " " << b.custId << " " << b.roomId << " "
-          << b.roomTypeId << " " << b.days << " " << (int)b.status << "\n";
+          << b.roomTypeId << " " << b.days << " " << (int)b.status << " "
+          << b.checkIn << " " << b.amount << "\n";
     }
+    if (f) HOTEL_BYTES(SaveBookings, f.tellp());
+    f.close();
+    return !f.fail();
 }
 
-void Hotel::savePayments() {
-    std::ofstream f("payments.dat");
-    for (const auto& p : payments) {
-        f << p.paymentId << " " << p.bookingId << " " << p.baseAmount << " "
-          << p.extraCharges << " " << p.taxRate << "\n";
+bool Hotel::savePayments(const std::string& path) {
+    HOTEL_TIMED(SavePayments);
+    std::ofstream f(path);
+    for (size_t i = 0; i < payments.size(); i++) {
+        f << payments.paymentId[i] << " " << payments.bookingId[i] << " "
+          << payments.baseAmount[i] << " " << payments.extraCharges[i] << " "
+          << payments.taxRate[i] << " " << payments.paidOn[i] << "\n";
     }
+    if (f) HOTEL_BYTES(SavePayments, f.tellp());
+    f.close();
+    return !f.fail();
 }
 
-void Hotel::saveMaintenance() {
-    std::ofstream f("maintenance.dat");
+bool Hotel::saveMaintenance(const std::string& path) {
+    HOTEL_TIMED(SaveMaintenance);
+    std::ofstream f(path);
     for (const auto& m : maintenanceLogs) {
         f << m.maintId << " " << m.roomId << " " << m.issue << " "
-          << (int)m.status << " " << m.scheduledDate << "\n";
+          << (int)m.status << " " << m.scheduledDate << " " << (int)m.priority << " "
+          << m.day << " " << m.dueDay << " " << m.staffId << " " << m.completedOn << "\n";
     }
+    if (f) HOTEL_BYTES(SaveMaintenance, f.tellp());
+    f.close();
+    return !f.fail();
+}
+
+// staffId salary role name (the name runs to the end of the line)
+bool Hotel::saveStaff(const std::string& path) {
+    std::ofstream f(path);
+    for (const auto& s : staff)
+        f << s.staffId << " " << s.salary << " " << s.role << " " << s.name << "\n";
+    f.close();
+    return !f.fail();
 }
 
 void Hotel::saveAll() {
-    saveRooms();
-    saveCustomers();
-    saveBookings();
-    savePayments();
-    saveMaintenance();
+    HOTEL_TIMED(SaveAll);
+    trace::Scope call(tracer, "saveAll");
+    awaitLazyTables();
+    std::lock_guard<std::mutex> persist(persistMutex);
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    saveTables();
+}
+
+// Nothing is overwritten in place: the tables go into a new generation
+// directory that only becomes current when its MANIFEST is committed
+bool Hotel::saveTables() {
+    std::string dir = generations.begin();
+    if (dir.empty()) {
+        std::cerr << "Cannot create a new generation in " << (dataDir.empty() ? "." : dataDir) << "\n";
+        return false;
+    }
+
+    std::vector<std::string> files{ "staff.dat" };
+    if (binarySnapshots) files.push_back("hotel.snap");
+    else files.insert(files.end(), { "rooms.dat", "customers.dat", "bookings.dat", "payments.dat", "maintenance.dat" });
+
+    auto in = [&](const char* file) { return dir + "/" + file; };
+    bool ok = saveStaff(in("staff.dat"));
+    if (binarySnapshots) {
+        ok = ok && saveSnapshot(in("hotel.snap"));
+    } else {
+        ok = ok && saveRooms(in("rooms.dat")) && saveCustomers(in("customers.dat")) &&
+             saveBookings(in("bookings.dat")) && savePayments(in("payments.dat")) &&
+             saveMaintenance(in("maintenance.dat"));
+    }
+
+    if (!ok || !generations.commit(files)) {
+        std::cerr << "Failed to save " << dir << ", keeping the previous generation\n";
+        return false;
+    }
+    rotateJournal();
+    return true;
 }
 
 /* ================= Load from Files ================= */
 
+// parseLines stops at a malformed line; say so rather than quietly
+// loading part of a table
+static void warnMalformed(const std::string& path) {
+    std::cerr << path << ": malformed line, the rest of the table was not loaded\n";
+}
+
 void Hotel::loadRooms() {
-    std::ifstream f("rooms.dat");
-    if (!f) return;
+    std::string text;
+    if (!readWholeFile(tablePath("rooms.dat"), text)) return;
 
-    rooms.clear();
-    int id, type, status;
-    double price;
+    bool complete = true;
+    rooms = parseLines<Room>(text, [](LineFields& in, Room& r) {
+        int id, type, status;
+        double price;
+        if (!(in.next(id) && in.next(type) && in.next(status) && in.next(price))) return false;
+        if (!isRoomStatus(status)) return false;
 
-    while (f >> id >> type >> status >> price) {
-        Room r(id, type, price);
+        r = Room(id, type, price);
         r.status = (RoomStatus)status;
-        rooms.push_back(r);
-    }
+        return true;
+    }, &complete);
+    if (!complete) warnMalformed(tablePath("rooms.dat"));
 
     if (!rooms.empty()) {
         nextRoomId = rooms.back().roomId + 1;
@@ -304,16 +1240,19 @@ void Hotel::loadRooms() {
 }
 
 void Hotel::loadCustomers() {
-    std::ifstream f("customers.dat");
-    if (!f) return;
+    std::string text;
+    if (!readWholeFile(tablePath("customers.dat"), text)) return;
 
-    customers.clear();
-    int id;
-    std::string name, phone, email;
+    bool complete = true;
+    customers = parseLines<Customer>(text, [this](LineFields& in, Customer& c) {
+        int id;
+        std::string_view name, phone, email;
+        if (!(in.next(id) && in.next(name) && in.next(phone) && in.next(email))) return false;
 
-    while (f >> id >> name >> phone >> email) {
-        customers.emplace_back(id, name, phone, email);
-    }
+        c = Customer(id, strings.store(name), strings.store(phone), strings.store(email));
+        return true;
+    }, &complete);
+    if (!complete) warnMalformed(tablePath("customers.dat"));
 
     if (!customers.empty()) {
         nextCustomerId = customers.back().custId + 1;
@@ -321,73 +1260,673 @@ void Hotel::loadCustomers() {
 }
 
 void Hotel::loadBookings() {
-    std::ifstream f("bookings.dat");
-    if (!f) return;
-
-    bookings.clear();
-    int bid, cid, rid, rtid, days, status;
-
-    while (f >> bid >> cid >> rid >> rtid >> days >> status) {
-        Booking b(bid, cid, rid, rtid, days);
+    std::string text;
+    if (!readWholeFile(tablePath("bookings.dat"), text)) return;
+
+    // Older files have no check-in or amount column
+    bool complete = true;
+    bookings = parseLines<Booking>(text, [](LineFields& in, Booking& b) {
+        int bid, cid, rid, rtid, days, status, checkIn = 0;
+        double amount = 0.0;
+        if (!(in.next(bid) && in.next(cid) && in.next(rid) && in.next(rtid) &&
+              in.next(days) && in.next(status)))
+            return false;
+        if (!isBookingStatus(status)) return false;
+        if (!in.next(checkIn)) checkIn = 0;
+        else if (!in.next(amount)) amount = 0.0;
+
+        b = Booking(bid, cid, rid, rtid, days, checkIn);
         b.status = (BookingStatus)status;
-        bookings.push_back(b);
-    }
+        b.amount = amount;
+        return true;
+    }, &complete);
+    if (!complete) warnMalformed(tablePath("bookings.dat"));
 
     if (!bookings.empty()) {
         nextBookingId = bookings.back().bookingId + 1;
     }
 }
 
-void Hotel::loadPayments() {
-    std::ifstream f("payments.dat");
-    if (!f) return;
+bool Hotel::loadPayments(PaymentLedger& out, int& nextId) {
+    std::string text;
+    if (!readWholeFile(tablePath("payments.dat"), text)) return false;
+
+    // Older files have no payment date column
+    bool complete = true;
+    std::vector<Payment> rows = parseLines<Payment>(text, [](LineFields& in, Payment& p) {
+        int pid, bid, paidOn = 0;
+        double base, extra, tax;
+        if (!(in.next(pid) && in.next(bid) && in.next(base) && in.next(extra) && in.next(tax)))
+            return false;
+        if (!in.next(paidOn)) paidOn = 0;
+
+        p = Payment(pid, bid, base, extra, tax, paidOn);
+        return true;
+    }, &complete);
+    if (!complete) warnMalformed(tablePath("payments.dat"));
+
+    out.clear();
+    out.reserve(rows.size());
+    for (const auto& p : rows) out.push_back(p);
+
+    if (!out.empty()) {
+        nextId = out.paymentId.back() + 1;
+    }
+    return true;
+}
 
-    payments.clear();
-    int pid, bid;
-    double base, extra, tax;
+bool Hotel::loadMaintenance(std::vector<Maintenance>& out, int& nextId) {
+    std::string text;
+    if (!readWholeFile(tablePath("maintenance.dat"), text)) return false;
 
-    while (f >> pid >> bid >> base >> extra >> tax) {
-        payments.emplace_back(pid, bid, base, extra, tax);
-    }
+    bool complete = true;
+    out = parseLines<Maintenance>(text, [this](LineFields& in, Maintenance& m) {
+        int mid, rid, status;
+        std::string_view issue, date;
+        if (!(in.next(mid) && in.next(rid) && in.next(issue) && in.next(status) && in.next(date)))
+            return false;
+        if (!isMaintStatus(status)) return false;
+
+        m = Maintenance(mid, rid, strings.intern(issue), strings.intern(date));
+        m.status = (MaintStatus)status;
 
-    if (!payments.empty()) {
-        nextPaymentId = payments.back().paymentId + 1;
+        // Older files end here
+        int priority, day, due, staffId, completedOn;
+        if (in.next(priority) && in.next(day) && in.next(due) && in.next(staffId) && in.next(completedOn)) {
+            if (!isMaintPriority(priority)) return false;
+            m.priority = (MaintPriority)priority;
+            m.day = day;
+            m.dueDay = due;
+            m.staffId = staffId;
+            m.completedOn = completedOn;
+        }
+        m.upgrade();
+        return true;
+    }, &complete);
+    if (!complete) warnMalformed(tablePath("maintenance.dat"));
+
+    if (!out.empty()) {
+        nextId = out.back().maintId + 1;
     }
+    return true;
 }
 
-void Hotel::loadMaintenance() {
-    std::ifstream f("maintenance.dat");
+void Hotel::loadStaff() {
+    std::ifstream f(tablePath("staff.dat"));
     if (!f) return;
 
-    maintenanceLogs.clear();
-    int mid, rid, status;
-    std::string issue, date;
+    staff.clear();
+    std::string line;
+    while (std::getline(f, line)) {
+        std::istringstream in(line);
+        Staff s;
+        if (!(in >> s.staffId >> s.salary >> s.role)) break;
+        std::getline(in >> std::ws, s.name);
+        staff.push_back(s);
+    }
 
-    while (f >> mid >> rid >> issue >> status >> date) {
-        Maintenance m(mid, rid, issue, date);
-        m.status = (MaintStatus)status;
-        maintenanceLogs.push_back(m);
+    if (!staff.empty()) {
+        nextStaffId = staff.back().staffId + 1;
     }
+}
+
+/* ================= Lazy Tables ================= */
+
+void Hotel::startLazyLoad() {
+    lazyHavePayments = lazyHaveMaintenance = false;
+    lazyPending.store(true, std::memory_order_release);
+
+    lazyLoad = std::async(std::launch::async, [this] {
+        auto maint = std::async(std::launch::async, [this] {
+            lazyHaveMaintenance = loadMaintenance(lazyMaintenance, lazyNextMaintId);
+        });
+        lazyHavePayments = loadPayments(lazyPayments, lazyNextPaymentId);
+        maint.get();
+    });
+}
+
+void Hotel::awaitLazyTables() const {
+    if (!lazyPending.load(std::memory_order_acquire)) return;
+
+    std::lock_guard<std::mutex> lazy(lazyMutex);
+    if (!lazyPending.load(std::memory_order_acquire)) return;
 
-    if (!maintenanceLogs.empty()) {
-        nextMaintId = maintenanceLogs.back().maintId + 1;
+    std::unique_lock<std::shared_mutex> lock(tableMutex);
+    // Completing the load is not an observable change, so const
+    // readers may do it too
+    const_cast<Hotel*>(this)->adoptLazyTables();
+}
+
+// Needs lazyMutex and an exclusive tableMutex
+void Hotel::adoptLazyTables() {
+    lazyLoad.get();
+
+    if (lazyHavePayments) {
+        payments = std::move(lazyPayments);
+        nextPaymentId = lazyNextPaymentId;
     }
+    if (lazyHaveMaintenance) {
+        maintenanceLogs = std::move(lazyMaintenance);
+        nextMaintId = lazyNextMaintId;
+    }
+    lazyPayments.clear();
+    lazyMaintenance.clear();
+
+    paymentIndex.clear();
+    paymentIndex.reserve(payments.size());
+    for (size_t i = 0; i < payments.size(); i++) paymentIndex.emplace(payments.paymentId[i], i);
+
+    maintIndex.clear();
+    maintIndex.reserve(maintenanceLogs.size());
+    for (size_t i = 0; i < maintenanceLogs.size(); i++) maintIndex.emplace(maintenanceLogs[i].maintId, i);
+
+    rebuildPaymentStats();
+    occupancy.beginRebuild();   // the stays are in place already
+    placePayments();
+    occupancy.endRebuild();
+    rebuildMaintenanceQueue();
+    lazyPending.store(false, std::memory_order_release);
 }
 
 void Hotel::loadAll() {
-    loadRooms();
-    loadCustomers();
-    loadBookings();
-    loadPayments();
-    loadMaintenance();
+    HOTEL_TIMED(LoadAll);
+    trace::Scope call(tracer, "loadAll");
+    awaitLazyTables();   // a previous background load lands first
+
+    std::lock_guard<std::mutex> lazy(lazyMutex);
+    std::lock_guard<std::mutex> persist(persistMutex);
+    std::unique_lock<std::shared_mutex> lock(tableMutex);
+
+    // Everything below reads the newest generation that verifies, or
+    // the top-level files of a directory written before generations.
+    // If every committed generation is damaged, starting from defaults
+    // would prune them and replay the journal onto an empty hotel.
+    if (!generations.recover() && generations.damaged())
+        throw std::runtime_error("No generation in " + (dataDir.empty() ? std::string(".") : dataDir) +
+                                 " verifies; refusing to load it. Move the damaged gen-* "
+                                 "directories aside to start over.");
+    adoptLegacyJournal();
+    loadStaff();
+    bool fromDat = !loadSnapshot();
+    if (fromDat) {
+        // The tables are independent until the indexes are built. Rooms,
+        // customers and bookings load in parallel; payments and
+        // maintenance history keep loading after we return.
+        startLazyLoad();
+        auto r = std::async(std::launch::async, [this] { loadRooms(); });
+        auto c = std::async(std::launch::async, [this] { loadCustomers(); });
+        loadBookings();
+        r.get();
+        c.get();
+    }
+    rebuildIndexes();
+
+    // Segments based on this generation or a newer one that did not
+    // verify hold everything changed since it was written
+    std::vector<std::string> segments;
+    for (uint64_t base : journalSegments()) {
+        std::string path = journalSegment(base);
+        if (base >= generations.current() && Journal::hasRecords(path)) segments.push_back(path);
+    }
+
+    // Journal records can update any table, so replay needs them all
+    if (fromDat && !segments.empty()) adoptLazyTables();
+
+    journal.rotate(journalSegment(generations.current()));
+    if (replayJournal(segments) > 0) saveTables();
+
+    rebuildCalendars();
+    rebuildFreePools();
+    rebuildStats();
+    rebuildOccupancy();
+    rebuildVersions();
+    rebuildMaintenanceQueue();
+}
+
+/* ================= Binary Snapshot ================= */
+
+bool Hotel::saveSnapshot(const std::string& path) {
+    HOTEL_TIMED(SaveSnapshot);
+    return writeSnapshot(path, rooms, customers, bookings, payments, maintenanceLogs);
+}
+
+bool Hotel::loadSnapshot() {
+    HOTEL_TIMED(LoadSnapshot);
+    SnapshotReader snap;
+    if (!snap.open(tablePath("hotel.snap"))) return false;
+
+    bool ok = snap.readRooms(rooms) && snap.readCustomers(customers, strings) &&
+              snap.readBookings(bookings) && snap.readPayments(payments) &&
+              snap.readMaintenance(maintenanceLogs, strings);
+    if (!ok) {
+        std::cerr << tablePath("hotel.snap") << " is truncated or corrupt.\n";
+        rooms.clear();
+        customers.clear();
+        bookings.clear();
+        payments.clear();
+        maintenanceLogs.clear();
+        return false;
+    }
+
+    binarySnapshots = true;
+    if (!rooms.empty()) nextRoomId = rooms.back().roomId + 1;
+    if (!customers.empty()) nextCustomerId = customers.back().custId + 1;
+    if (!bookings.empty()) nextBookingId = bookings.back().bookingId + 1;
+    if (!payments.empty()) nextPaymentId = payments.paymentId.back() + 1;
+    if (!maintenanceLogs.empty()) nextMaintId = maintenanceLogs.back().maintId + 1;
+    return true;
+}
+
+bool Hotel::convertToBinarySnapshot() {
+    trace::Scope call(tracer, "convertToBinarySnapshot");
+    awaitLazyTables();
+    std::lock_guard<std::mutex> persist(persistMutex);
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    binarySnapshots = true;
+    if (saveTables()) return call.ret(true);
+
+    binarySnapshots = false;
+    return call.ret(false);
+}
+
+/* ================= Bulk Import / Export ================= */
+
+bool Hotel::importBatch(bulk::Batch& batch) {
+    HOTEL_TIMED(BulkImport);
+    // The rows are not traced, only how many of each there were
+    trace::Scope call(tracer, "importBatch", (int)batch.rooms.size(), (int)batch.customers.size(),
+                      (int)batch.bookings.size());
+    awaitLazyTables();
+    std::lock_guard<std::mutex> persist(persistMutex);
+    std::unique_lock<std::shared_mutex> lock(tableMutex);
+
+    // Rows are checked against the indexes, which pick up every
+    // accepted row, so duplicates inside the batch are caught too. A row
+    // identical to the record already stored is skipped as unchanged,
+    // so an import can be re-run after fixing the rejected rows.
+    size_t before = rooms.size();
+    bool ordered = true;
+    int maxId = nextRoomId - 1;
+    roomIndex.reserve(rooms.size() + batch.rooms.size());
+    for (size_t i = 0; i < batch.rooms.size(); i++) {
+        Room r = batch.rooms[i];
+        auto known = roomIndex.find(r.roomId);
+        if (known != roomIndex.end()) {
+            const Room& old = rooms[known->second];
+            if (old.typeId == r.typeId && old.customPrice == r.customPrice) batch.unchanged++;
+            else batch.reject(batch.roomsPath, batch.roomLines[i], "duplicate roomId");
+            continue;
+        }
+        if (!roomTypeIndex.count(r.typeId)) {
+            batch.reject(batch.roomsPath, batch.roomLines[i], "unknown typeId");
+            continue;
+        }
+        // Booked follows from the bookings, see rebuildCalendars()
+        if (r.status == RoomStatus::Booked) r.status = RoomStatus::Available;
+        ordered = ordered && r.roomId > maxId;
+        maxId = std::max(maxId, r.roomId);
+        roomIndex.emplace(r.roomId, rooms.size());
+        rooms.push_back(r);
+    }
+    batch.importedRooms = rooms.size() - before;
+    nextRoomId = maxId + 1;
+
+    before = customers.size();
+    maxId = nextCustomerId - 1;
+    customerIndex.reserve(customers.size() + batch.customers.size());
+    for (size_t i = 0; i < batch.customers.size(); i++) {
+        const Customer& c = batch.customers[i];
+        auto known = customerIndex.find(c.custId);
+        if (known != customerIndex.end()) {
+            const Customer& old = customers[known->second];
+            if (old.name == c.name && old.phone == c.phone && old.email == c.email) batch.unchanged++;
+            else batch.reject(batch.customersPath, batch.customerLines[i], "duplicate custId");
+            continue;
+        }
+        ordered = ordered && c.custId > maxId;
+        maxId = std::max(maxId, c.custId);
+        customerIndex.emplace(c.custId, customers.size());
+        customers.emplace_back(c.custId, strings.store(c.name), strings.store(c.phone),
+                               strings.store(c.email));
+    }
+    batch.importedCustomers = customers.size() - before;
+    nextCustomerId = maxId + 1;
+
+    // Confirmed stays must not overlap; the calendars are rebuilt below
+    calendars.resize(rooms.size());
+    before = bookings.size();
+    maxId = nextBookingId - 1;
+    bookingIndex.reserve(bookings.size() + batch.bookings.size());
+    for (size_t i = 0; i < batch.bookings.size(); i++) {
+        Booking b = batch.bookings[i];
+        auto room = roomIndex.find(b.roomId);
+        const char* why = !customerIndex.count(b.custId) ? "unknown custId"
+                        : room == roomIndex.end()        ? "unknown roomId"
+                        : nullptr;
+        if (!why) {
+            auto slot = bookingIndex.try_emplace(b.bookingId, bookings.size());
+            if (!slot.second) {
+                const Booking& old = bookings[slot.first->second];
+                if (old.custId == b.custId && old.roomId == b.roomId && old.checkIn == b.checkIn &&
+                    old.days == b.days && old.status == b.status && old.amount == b.amount) {
+                    batch.unchanged++;
+                    continue;
+                }
+                why = "duplicate bookingId";
+            } else if (b.status == BookingStatus::Confirmed &&
+                       !calendars[room->second].reserve(b.checkIn, b.checkOut(), b.bookingId)) {
+                why = "overlaps another confirmed stay";
+                bookingIndex.erase(slot.first);
+            }
+        }
+        if (why) {
+            batch.reject(batch.bookingsPath, batch.bookingLines[i], why);
+            continue;
+        }
+        b.roomTypeId = rooms[room->second].typeId;
+        ordered = ordered && b.bookingId > maxId;
+        maxId = std::max(maxId, b.bookingId);
+        bookings.push_back(b);
+    }
+    batch.importedBookings = bookings.size() - before;
+    nextBookingId = maxId + 1;
+
+    // Loaders take the last record's ID + 1 as the next one, so the
+    // tables stay in ID order
+    if (ordered) {
+        customerLookup.build(customers);
+    } else {
+        auto byId = [](auto key) {
+            return [key](const auto& a, const auto& b) { return a.*key < b.*key; };
+        };
+        std::sort(rooms.begin(), rooms.end(), byId(&Room::roomId));
+        std::sort(customers.begin(), customers.end(), byId(&Customer::custId));
+        std::sort(bookings.begin(), bookings.end(), byId(&Booking::bookingId));
+        rebuildIndexes();
+    }
+
+    rebuildCalendars();
+    rebuildFreePools();
+    rebuildStats();
+    rebuildOccupancy();
+    rebuildVersions();
+
+    binarySnapshots = true;
+    return call.ret(saveTables());
+}
+
+bool Hotel::exportTables(const std::string& dir, bulk::Format format) const {
+    HOTEL_TIMED(BulkExport);
+    trace::Scope call(tracer, "exportTables", dir, (int)format);
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    std::string ext = bulk::extension(format);
+
+    std::ofstream r(dir + "/rooms" + ext, std::ios::binary);
+    std::ofstream c(dir + "/customers" + ext, std::ios::binary);
+    std::ofstream b(dir + "/bookings" + ext, std::ios::binary);
+    if (!r || !c || !b) return call.ret(false);
+
+    bulk::writeRooms(r, rooms, format);
+    bulk::writeCustomers(c, customers, format);
+    bulk::writeBookings(b, bookings, format);
+    HOTEL_BYTES(BulkExport, (size_t)r.tellp() + (size_t)c.tellp() + (size_t)b.tellp());
+    return call.ret(r.good() && c.good() && b.good());
+}
+
+/* ================= Journal ================= */
+
+void Hotel::enableJournal(size_t checkpointInterval, bool sync) {
+    std::lock_guard<std::mutex> persist(persistMutex);
+    checkpointEvery = checkpointInterval;
+    journal.setSync(sync);
+    journalEnabled = journal.open();
+    if (!journalEnabled)
+        std::cerr << "Could not open " << journal.getPath() << ", falling back to full saves.\n";
+}
+
+void Hotel::enableGroupCommit(std::chrono::microseconds window, size_t maxBatch,
+                              size_t checkpointInterval) {
+    journal.setGroupCommit(window, maxBatch);
+    enableJournal(checkpointInterval, true);
+}
+
+bool Hotel::lastChangeUnsaved() {
+    return unsavedChange;
+}
+
+// True once the change is durable: in the journal, or in a full save
+// when the journal is off or failed
+bool Hotel::commit(const JournalEntry& e) {
+    HOTEL_TIMED(Commit);
+    unsavedChange = false;
+    std::unique_lock<std::mutex> persist(persistMutex, std::defer_lock);
+
+    // Grouped appends wait for their batch without persistMutex, so that
+    // concurrent callers can share one write and one fdatasync
+    bool grouped = journalEnabled && journal.isGrouped();
+    if (!grouped) persist.lock();
+
+    bool failed = false;
+    if (journalEnabled && !journal.append(e)) {
+        std::cerr << "Journal write failed, saving full snapshot.\n";
+        failed = true;
+    }
+
+    auto due = [&] {
+        return journalEnabled && checkpointEvery > 0 && journal.pendingRecords() >= checkpointEvery;
+    };
+    bool fold = !journalEnabled || failed || due();
+    if (!fold) return true;
+
+    if (grouped) {
+        persist.lock();
+        // Another caller of the same batch may have folded already
+        if (!failed && !due()) return true;
+    }
+
+    // A full save needs the lazily loaded tables; lazyMutex comes
+    // before persistMutex in the lock order
+    if (lazyPending.load(std::memory_order_acquire)) {
+        persist.unlock();
+        awaitLazyTables();
+        persist.lock();
+    }
+
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    bool saved = saveTables();
+
+    // A checkpoint that fails leaves the change safe in the journal
+    if (saved || (journalEnabled && !failed)) return true;
+    std::cerr << "Change could not be saved; it is kept in memory until the next save.\n";
+    unsavedChange = true;
+    return false;
+}
+
+void Hotel::checkpoint() {
+    HOTEL_TIMED(Checkpoint);
+    trace::Scope call(tracer, "checkpoint");
+    awaitLazyTables();
+    std::lock_guard<std::mutex> persist(persistMutex);
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    saveTables();
+}
+
+// journal-000042.log holds the changes made on top of generation 42
+std::string Hotel::journalSegment(uint64_t base) const {
+    char name[40];
+    std::snprintf(name, sizeof(name), "journal-%06" PRIu64 ".log", base);
+    return dataPath(name);
+}
+
+// Bases of the segments on disk, oldest first
+std::vector<uint64_t> Hotel::journalSegments() const {
+    std::vector<uint64_t> found;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dataDir.empty() ? "." : dataDir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() <= 12 || name.compare(0, 8, "journal-") != 0 ||
+            name.compare(name.size() - 4, 4, ".log") != 0)
+            continue;
+        std::string digits = name.substr(8, name.size() - 12);
+        if (digits.find_first_not_of("0123456789") == std::string::npos)
+            found.push_back(std::stoull(digits));
+    }
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+// journal.log predates segments and was emptied on every save, so
+// whatever it holds applies on top of the generation just recovered
+void Hotel::adoptLegacyJournal() {
+    std::error_code ec;
+    std::string legacy = dataPath("journal.log");
+    std::string segment = journalSegment(generations.current());
+    if (std::filesystem::exists(legacy, ec) && !std::filesystem::exists(segment, ec))
+        std::filesystem::rename(legacy, segment, ec);
+}
+
+// A committed save starts a new segment. The older ones stay while the
+// generation they apply to is kept: if the new generation fails to
+// verify later, recovery falls back to that one and replays them all.
+void Hotel::rotateJournal() {
+    if (!journal.rotate(journalSegment(generations.current())))
+        std::cerr << "Could not open " << journal.getPath() << "\n";
+
+    std::error_code ec;
+    for (uint64_t base : journalSegments())
+        if (base < generations.fallback()) std::filesystem::remove(journalSegment(base), ec);
+}
+
+size_t Hotel::replayJournal(const std::vector<std::string>& segments) {
+    HOTEL_TIMED(JournalReplay);
+    size_t applied = 0;
+    for (const std::string& path : segments)
+        applied += Journal::replay(path, [this](const std::vector<std::string>& f) {
+            applyJournalEntry(f);
+        });
+    return applied;
+}
+
+void Hotel::applyJournalEntry(const std::vector<std::string>& f) {
+    size_t i = 0;
+
+    auto has = [&](size_t n) { return i + n <= f.size(); };
+    auto num = [&](size_t k) { return std::stoi(f[i + k]); };
+    auto real = [&](size_t k) { return std::stod(f[i + k]); };
+
+    while (i < f.size()) {
+        const std::string& tag = f[i++];
+
+        // A record with an unknown status is skipped like a malformed one
+        if (tag == "R" && has(4) && isRoomStatus(num(2))) {
+            Room* r = findRoom(num(0));
+            if (!r) {
+                roomIndex.emplace(num(0), rooms.size());
+                rooms.push_back(Room(num(0), num(1), real(3)));
+                r = &rooms.back();
+            }
+            r->typeId = num(1);
+            r->status = (RoomStatus)num(2);
+            r->customPrice = real(3);
+            nextRoomId = std::max(nextRoomId, r->roomId + 1);
+            i += 4;
+
+        } else if (tag == "C" && has(4)) {
+            int id = num(0);
+            auto it = customerIndex.find(id);
+            Customer nc(id, strings.store(f[i + 1]), strings.store(f[i + 2]), strings.store(f[i + 3]));
+            if (it != customerIndex.end()) {
+                customerLookup.remove(customers[it->second], it->second);
+                customers[it->second] = nc;
+                customerLookup.add(nc, it->second);
+            } else {
+                customerIndex.emplace(id, customers.size());
+                customers.push_back(nc);
+                customerLookup.add(nc, customers.size() - 1);
+            }
+            nextCustomerId = std::max(nextCustomerId, id + 1);
+            i += 4;
+
+        } else if (((tag == "B" && has(6)) || (tag == "BK" && has(7)) || (tag == "BQ" && has(8))) &&
+                   isBookingStatus(num(5))) {
+            // "B" records predate check-in dates, "BK" quoted amounts
+            Booking nb(num(0), num(1), num(2), num(3), num(4), (tag != "B") ? num(6) : 0);
+            nb.status = (BookingStatus)num(5);
+            if (tag == "BQ") nb.amount = real(7);
+            Booking* b = findBooking(nb.bookingId);
+            if (b) {
+                *b = nb;
+            } else {
+                bookingIndex.emplace(nb.bookingId, bookings.size());
+                bookings.push_back(nb);
+            }
+            nextBookingId = std::max(nextBookingId, nb.bookingId + 1);
+            i += (tag == "BQ") ? 8 : (tag == "BK") ? 7 : 6;
+
+        } else if ((tag == "P" && has(5)) || (tag == "PD" && has(6))) {
+            // "P" records predate payment dates; room types are filled
+            // in by rebuildStats once the bookings are loaded
+            Payment np(num(0), num(1), real(2), real(3), real(4), (tag == "PD") ? num(5) : 0);
+            auto it = paymentIndex.find(np.paymentId);
+            if (it != paymentIndex.end()) {
+                payments.set(it->second, np);
+            } else {
+                paymentIndex.emplace(np.paymentId, payments.size());
+                payments.push_back(np);
+            }
+            nextPaymentId = std::max(nextPaymentId, np.paymentId + 1);
+            i += (tag == "PD") ? 6 : 5;
+
+        } else if (((tag == "M" && has(5)) || (tag == "MJ" && has(10))) && isMaintStatus(num(3)) &&
+                   (tag == "M" || isMaintPriority(num(5)))) {
+            // "M" records predate priorities and technicians
+            Maintenance nm(num(0), num(1), strings.intern(f[i + 2]), strings.intern(f[i + 4]));
+            nm.status = (MaintStatus)num(3);
+            if (tag == "MJ") {
+                nm.priority = (MaintPriority)num(5);
+                nm.day = num(6);
+                nm.dueDay = num(7);
+                nm.staffId = num(8);
+                nm.completedOn = num(9);
+            }
+            nm.upgrade();
+            auto it = maintIndex.find(nm.maintId);
+            if (it != maintIndex.end()) {
+                maintenanceLogs[it->second] = nm;
+            } else {
+                maintIndex.emplace(nm.maintId, maintenanceLogs.size());
+                maintenanceLogs.push_back(nm);
+            }
+            nextMaintId = std::max(nextMaintId, nm.maintId + 1);
+            i += (tag == "MJ") ? 10 : 5;
+
+        } else if (tag == "S" && has(4)) {
+            Staff ns(num(0), f[i + 1], f[i + 2], real(3));
+            auto it = std::find_if(staff.begin(), staff.end(),
+                                   [&](const Staff& s) { return s.staffId == ns.staffId; });
+            if (it != staff.end()) *it = ns;
+            else staff.push_back(ns);
+            nextStaffId = std::max(nextStaffId, ns.staffId + 1);
+            i += 4;
+
+        } else {
+            std::cerr << "Skipping malformed journal record '" << tag << "'\n";
+            return;
+        }
+    }
 }
 
 /* ================= Utility Print Functions ================= */
 
+// The listings and reports below print from a pinned HotelView, so
+// writers are never held up by console output
+
 void Hotel::printRooms() const {
+    trace::Scope call(tracer, "printRooms");
+    HotelView view = pinView();
     std::cout << "\n--- Rooms ---\n";
-    for (const auto& r : rooms) {
-        const RoomType* rt = getRoomTypeById(r.typeId);
+    for (const auto& r : view.rooms) {
+        const RoomType* rt = view.roomType(r.typeId);
 
         std::cout << "Room ID: " << r.roomId
                   << ", Type: " << (rt ? rt->name : "Unknown")
@@ -396,8 +1935,10 @@ void Hotel::printRooms() const {
 }
 
 void Hotel::printCustomers() const {
+    trace::Scope call(tracer, "printCustomers");
+    HotelView view = pinView();
     std::cout << "\n--- Customers ---\n";
-    for (const auto& c : customers) {
+    for (const auto& c : view.customers) {
         std::cout << "ID: " << c.custId
                   << ", Name: " << c.name
                   << ", Phone: " << c.phone
@@ -406,12 +1947,15 @@ void Hotel::printCustomers() const {
 }
 
 void Hotel::printBookings() const {
+    trace::Scope call(tracer, "printBookings");
+    HotelView view = pinView();
     std::cout << "\n--- Bookings ---\n";
-    for (const auto& b : bookings) {
+    for (const auto& b : view.bookings) {
         std::cout << "Booking ID: " << b.bookingId
                   << ", Customer ID: " << b.custId
                   << ", Room ID: " << b.roomId
                   << ", Type ID: " << b.roomTypeId
+                  << ", Check-in: " << (b.checkIn ? formatDate(b.checkIn) : "-")
                   << ", Days: " << b.days
                   << ", Status: " << (int)b.status << "\n";
     }
@@ -419,98 +1963,165 @@ void Hotel::printBookings() const {
 
 /* ================= Dashboard Export ================= */
 
-void Hotel::exportToJSON() {
-   std::ofstream f("dashboard/dashboard_data.json");
+// Writes the dashboard JSON in one buffered write. With atomic set the
+// data goes to a temporary file that is renamed over the old one, so a
+// dashboard polling the file never sees it half written.
+bool Hotel::exportToJSON(const std::string& file, bool atomic) {
+    HOTEL_TIMED(ExportJSON);
+    trace::Scope call(tracer, "exportToJSON", file, (int)atomic);
+    std::string path = std::filesystem::path(file).is_absolute() ? file : dataPath(file.c_str());
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+    static thread_local JsonWriter w(true);   // keeps its buffer between exports
+    w.clear();
+    writeDashboardJSON(w);
+
+    if (!atomic) {
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+        if (!f) return call.ret(false);
+        f.write(w.str().data(), (std::streamsize)w.str().size());
+        f.put('\n');
+        return call.ret((bool)f.flush());
+    }
+
+    // A temp file of our own, so concurrent exports to the same path
+    // never write into each other's file; synced before it replaces path
+    std::string tmp = path + ".XXXXXX";
+    int fd = ::mkstemp(&tmp[0]);
+    if (fd < 0) return call.ret(false);
+    ::fchmod(fd, 0644);
+
+    auto writeAll = [fd](const char* p, size_t left) {
+        while (left > 0) {
+            ssize_t n = ::write(fd, p, left);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            p += n;
+            left -= (size_t)n;
+        }
+        return true;
+    };
+    bool ok = writeAll(w.str().data(), w.str().size()) && writeAll("\n", 1) && ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        return call.ret(false);
+    }
+    return call.ret(true);
+}
+
+std::string Hotel::dashboardJSON() const {
+    trace::Scope call(tracer, "dashboardJSON");
+    JsonWriter w;
+    writeDashboardJSON(w);
+    return w.take();
+}
+
+// Everything comes from the maintained aggregates; per-type revenue is
+// accumulated as payments are recorded (rebuildStats does the one pass
+// over payments after a load), so no payment or booking scans happen here.
+// The JSON is written from a pinned view, outside the table lock.
+void Hotel::writeDashboardJSON(JsonWriter& w) const {
+    trace::Scope call(tracer, "writeDashboardJSON");
+    HotelView view = pinView();
+    const HotelStats& stats = view.stats;
+
+    w.beginObject();
 
-    
-    f << "{\n";
-    
     // Room statistics
-    f << "  \"rooms\": {\n";
-    f << "    \"total\": " << rooms.size() << ",\n";
-    f << "    \"available\": " << countAvailableRooms() << ",\n";
-    f << "    \"booked\": " << countBookedRooms() << ",\n";
-    f << "    \"maintenance\": " << countMaintenanceRooms() << "\n";
-    f << "  },\n";
+    w.key("rooms").beginObject()
+        .field("total", view.rooms.size())
+        .field("available", stats.rooms(RoomStatus::Available))
+        .field("booked", stats.rooms(RoomStatus::Booked))
+        .field("maintenance", stats.rooms(RoomStatus::Maintenance))
+        .endObject();
 
     // Revenue summary
-    double totalRevenue = 0;
-    for (const auto& p : payments)
-        totalRevenue += p.total();
-
-    f << "  \"revenue\": {\n";
-    f << "    \"completed\": " << totalRevenue << ",\n";
-    f << "    \"estimated\": " << estimatedRevenueActive() << "\n";
-    f << "  },\n";
+    w.key("revenue").beginObject()
+        .field("completed", stats.completedRevenue)
+        .field("estimated", stats.estimatedActive)
+        .endObject();
 
     // Customers
-    f << "  \"customers\": {\n";
-    f << "    \"total\": " << customers.size() << "\n";
-    f << "  },\n";
+    w.key("customers").beginObject()
+        .field("total", view.customers.size())
+        .endObject();
 
     // Booking status
-    int confirmed = 0, cancelled = 0, checked = 0;
-    for (const auto& b : bookings) {
-        if (b.status == BookingStatus::Confirmed) confirmed++;
-        else if (b.status == BookingStatus::Cancelled) cancelled++;
-        else if (b.status == BookingStatus::CheckedOut) checked++;
-    }
-
-    f << "  \"bookings\": {\n";
-    f << "    \"total\": " << bookings.size() << ",\n";
-    f << "    \"confirmed\": " << confirmed << ",\n";
-    f << "    \"cancelled\": " << cancelled << ",\n";
-    f << "    \"checkedOut\": " << checked << "\n";
-    f << "  },\n";
+    w.key("bookings").beginObject()
+        .field("total", view.bookings.size())
+        .field("confirmed", stats.bookings(BookingStatus::Confirmed))
+        .field("cancelled", stats.bookings(BookingStatus::Cancelled))
+        .field("checkedOut", stats.bookings(BookingStatus::CheckedOut))
+        .endObject();
 
     // Room type revenue
-    f << "  \"roomTypeRevenue\": [\n";
-    for (size_t i = 0; i < roomTypes.size(); i++) {
-        double typeRevenue = 0;
-        for (const auto& p : payments) {
-            const Booking* b = findBooking(p.bookingId);
-            if (b && b->roomTypeId == roomTypes[i].typeId)
-                typeRevenue += p.total();
-        }
-
-        f << "    {\"type\": \"" << roomTypes[i].name << "\", \"revenue\": " << typeRevenue << "}";
-        if (i < roomTypes.size() - 1) f << ",";
-        f << "\n";
+    w.key("roomTypeRevenue").beginArray();
+    for (const auto& rt : view.roomTypes) {
+        auto it = stats.typeRevenue.find(rt.typeId);
+        w.beginObject()
+            .field("type", rt.name)
+            .field("revenue", (it != stats.typeRevenue.end()) ? it->second : 0.0)
+            .endObject();
+    }
+    w.endArray();
+
+    // Last twelve months, for the trend chart
+    int to = today() + 1;
+    w.key("occupancyTrend").beginArray();
+    for (const auto& p : readOccupancySeries(0, to - 365, to, Resolution::Month)) {
+        w.beginObject()
+            .field("start", formatDate(p.start))
+            .field("occupancy", p.occupancy())
+            .field("adr", p.adr())
+            .field("revpar", p.revpar())
+            .endObject();
     }
-    f << "  ]\n";
+    w.endArray();
 
-    f << "}\n";
+    w.endObject();
 }
 
 void Hotel::generateDashboardHTML() {
-    exportToJSON();
-    std::cout << "Dashboard data exported to dashboard_data.json\n";
+    trace::Scope call(tracer, "generateDashboardHTML");
+    std::string json = dataPath("dashboard/dashboard_data.json");
+    if (exportToJSON())
+        std::cout << "Dashboard data exported to " << json << "\n";
+    else
+        std::cout << "Could not write " << json << "\n";
+
+    // Only this property's operations when several share the process
+    std::string prom = dataPath("dashboard/metrics.prom");
+    if (metrics::enabled() && metrics::writePrometheusFile(prom, metricsProperty))
+        std::cout << "Metrics exported to " << prom << "\n";
 }
 
 /* ================= Dashboard (ASCII) ================= */
 
 void Hotel::showDashboard() {
+    trace::Scope call(tracer, "showDashboard");
+    HotelView view = pinView();
+    const HotelStats& stats = view.stats;
     std::cout << "\n===== HOTEL DASHBOARD =====\n";
-    std::cout << "Total Rooms: " << rooms.size() << "\n";
-    std::cout << "Available:   " << countAvailableRooms() << "\n";
-    std::cout << "Booked:      " << countBookedRooms() << "\n";
-    std::cout << "Maintenance: " << countMaintenanceRooms() << "\n";
-
-    double totalRevenue = 0;
-    for (const auto& p : payments)
-        totalRevenue += p.total();
+    std::cout << "Total Rooms: " << view.rooms.size() << "\n";
+    std::cout << "Available:   " << stats.rooms(RoomStatus::Available) << "\n";
+    std::cout << "Booked:      " << stats.rooms(RoomStatus::Booked) << "\n";
+    std::cout << "Maintenance: " << stats.rooms(RoomStatus::Maintenance) << "\n";
 
-    std::cout << "Completed Revenue: ₹" << totalRevenue << "\n";
-    std::cout << "Estimated Active Revenue: ₹" << estimatedRevenueActive() << "\n";
+    std::cout << "Completed Revenue: ₹" << stats.completedRevenue << "\n";
+    std::cout << "Estimated Active Revenue: ₹" << stats.estimatedActive << "\n";
 }
 
 
 /* ================= Reports ================= */
 
 void Hotel::printRoomsReport() {
+    trace::Scope call(tracer, "printRoomsReport");
+    HotelView view = pinView();
     std::cout << "\n===== ROOMS REPORT =====\n";
-    for (const auto& r : rooms) {
-        const RoomType* rt = getRoomTypeById(r.typeId);
+    for (const auto& r : view.rooms) {
+        const RoomType* rt = view.roomType(r.typeId);
         std::cout << "Room " << r.roomId
                   << " | Type: " << (rt ? rt->name : "Unknown")
                   << " | Status: " << statusToString(r.status) << "\n";
@@ -518,8 +2129,10 @@ void Hotel::printRoomsReport() {
 }
 
 void Hotel::printCustomerReport() {
+    trace::Scope call(tracer, "printCustomerReport");
+    HotelView view = pinView();
     std::cout << "\n===== CUSTOMER REPORT =====\n";
-    for (const auto& c : customers) {
+    for (const auto& c : view.customers) {
         std::cout << "ID: " << c.custId << " | "
                   << c.name << " | " << c.phone
                   << " | " << c.email << "\n";
@@ -527,13 +2140,173 @@ void Hotel::printCustomerReport() {
 }
 
 void Hotel::printRevenueReport() {
+    trace::Scope call(tracer, "printRevenueReport");
+    HotelView view = pinView();
+    const HotelStats& stats = view.stats;
     std::cout << "\n===== REVENUE REPORT =====\n";
 
-    double total = 0;
-    for (const auto& p : payments)
-        total += p.total();
+    std::cout << "Completed Revenue: ₹" << stats.completedRevenue << "\n";
+    std::cout << "Estimated Active Revenue: ₹" << stats.estimatedActive << "\n";
+
+    std::cout << "\nBy room type:\n";
+    for (const auto& rt : view.roomTypes) {
+        auto it = stats.typeRevenue.find(rt.typeId);
+        std::cout << "  " << rt.name << ": ₹" << ((it != stats.typeRevenue.end()) ? it->second : 0.0) << "\n";
+    }
+
+    // The ledger's column kernels over the payments the view saw; dated
+    // ones only, as in revenueByMonth()
+    std::vector<std::pair<int, double>> months;
+    {
+        std::shared_lock<std::shared_mutex> lock(tableMutex);
+        int first, last;
+        if (payments.dateRange(first, last, view.paymentRows))
+            months = payments.sumByMonth(first, last + 1, view.paymentRows);
+    }
+    if (months.empty()) return;
+
+    std::cout << "\nBy month:\n";
+    for (const auto& m : months) {
+        if (m.second == 0.0) continue;
+        std::cout << "  " << m.first / 100 << "-" << std::setw(2) << std::setfill('0')
+                  << m.first % 100 << std::setfill(' ') << ": ₹" << m.second << "\n";
+    }
+}
+
+void Hotel::printOccupancyReport() {
+    trace::Scope call(tracer, "printOccupancyReport");
+    std::vector<RoomType> types;
+    {
+        std::shared_lock<std::shared_mutex> lock(tableMutex);
+        types = roomTypes;
+    }
+    types.push_back(RoomType(0, "All types", 0.0, ""));
+
+    auto line = [](const OccupancyPoint& p) {
+        std::cout << std::setprecision(1) << p.occupancy() << "% occupied | ADR ₹"
+                  << std::setprecision(2) << p.adr() << " | RevPAR ₹" << p.revpar();
+    };
+
+    int to = today() + 1, from = to - 365;
+    std::ios::fmtflags flags = std::cout.flags();
+    std::cout << std::fixed << "\n===== OCCUPANCY REPORT =====\n";
+
+    std::cout << "Last 365 days:\n";
+    for (const auto& rt : types) {
+        OccupancyPoint p = readOccupancyTotal(rt.typeId, from, to);
+        std::cout << "  " << rt.name << ": ";
+        line(p);
+        std::cout << " | " << std::setprecision(0) << p.roomNights << " room nights\n";
+    }
+
+    std::cout << "\nBy month:\n";
+    for (const auto& p : readOccupancySeries(0, from, to, Resolution::Month)) {
+        int y, m, d;
+        civilFromDays(p.start, y, m, d);
+        std::cout << "  " << y << "-" << std::setw(2) << std::setfill('0') << m << std::setfill(' ') << ": ";
+        line(p);
+        std::cout << " | " << p.arrivals << " arrivals, " << p.departures << " departures, "
+                  << p.cancellations << " cancelled\n";
+    }
+    std::cout.flags(flags);
+    std::cout << std::setprecision(6);
+}
+
+void Hotel::printMaintenanceQueue() {
+    trace::Scope call(tracer, "printMaintenanceQueue");
+    dispatchMaintenance();   // jobs whose day has come since
+    std::vector<Maintenance> jobs = openMaintenance();
+    std::vector<Staff> team = getStaff();
+    int now = today();
+
+    std::cout << "\n===== MAINTENANCE QUEUE =====\n";
+    if (jobs.empty()) std::cout << "No open jobs.\n";
+    for (const auto& m : jobs) {
+        std::cout << "Job " << m.maintId << " | Room " << m.roomId << " | " << MAINT_PRIORITY[(int)m.priority]
+                  << " | " << m.issue << " | " << (m.day ? formatDate(m.day) : "-")
+                  << " | due " << formatDate(m.dueDay) << " | ";
+        if (m.status == MaintStatus::InProgress) std::cout << "in progress (staff " << m.staffId << ")";
+        else if (m.day > now) std::cout << "waiting";
+        else std::cout << "queued";
+        if (m.dueDay < now) std::cout << " | OVERDUE";
+        std::cout << "\n";
+    }
 
-    std::cout << "Completed Revenue: ₹" << total << "\n";
-    std::cout << "Estimated Active Revenue: ₹" << estimatedRevenueActive() << "\n";
+    std::cout << "\nTechnicians:\n";
+    for (const auto& s : team) {
+        if (!s.isTechnician()) continue;
+        auto job = std::find_if(jobs.begin(), jobs.end(), [&](const Maintenance& m) {
+            return m.status == MaintStatus::InProgress && m.staffId == s.staffId;
+        });
+        std::cout << "  " << s.staffId << " " << s.name << ": ";
+        if (job != jobs.end()) std::cout << "job " << job->maintId << " (room " << job->roomId << ")\n";
+        else std::cout << "idle\n";
+    }
 }
 
+void Hotel::printMemoryReport() {
+    trace::Scope call(tracer, "printMemoryReport");
+    awaitLazyTables();
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+
+    // Record layouts before the pool, for the comparison
+    struct StdCustomer { int custId; std::string name, phone, email; };
+    struct StdMaintenance {
+        int maintId, roomId; std::string issue; MaintStatus status; std::string date;
+        int day; MaintPriority priority; int dueDay, staffId, completedOn;
+    };
+
+    size_t custText = 0, custHeap = 0, custAllocs = 0;
+    for (const auto& c : customers) {
+        for (std::string_view s : { c.name, c.phone, c.email }) {
+            custText += s.size();
+            size_t heap = StringPool::stdStringHeapBytes(s.size());
+            custHeap += heap;
+            custAllocs += heap ? 1 : 0;
+        }
+    }
+
+    size_t maintHeap = 0, maintAllocs = 0, maintDistinct = 0;
+    std::unordered_map<const char*, size_t> distinct;   // interned values share storage
+    for (const auto& m : maintenanceLogs) {
+        for (std::string_view s : { m.issue, m.scheduledDate }) {
+            size_t heap = StringPool::stdStringHeapBytes(s.size());
+            maintHeap += heap;
+            maintAllocs += heap ? 1 : 0;
+            if (!s.empty() && distinct.emplace(s.data(), s.size()).second) maintDistinct += s.size();
+        }
+    }
+
+    StringPool::Stats ps = strings.stats();
+
+    size_t oldCustRecords = customers.size() * sizeof(StdCustomer);
+    size_t oldMaintRecords = maintenanceLogs.size() * sizeof(StdMaintenance);
+    size_t newCustRecords = customers.size() * sizeof(Customer);
+    size_t newMaintRecords = maintenanceLogs.size() * sizeof(Maintenance);
+
+    size_t oldTotal = oldCustRecords + custHeap + oldMaintRecords + maintHeap;
+    size_t newTotal = newCustRecords + newMaintRecords + ps.bytesReserved + ps.internTableBytes;
+
+    auto kb = [](size_t bytes) { return (double)bytes / 1024.0; };
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "\n===== MEMORY REPORT =====\n";
+    std::cout << "Customers: " << customers.size() << " (" << kb(custText) << " KB of text)\n";
+    std::cout << "  std::string layout: " << kb(oldCustRecords) << " KB records + "
+              << kb(custHeap) << " KB heap in " << custAllocs << " allocations\n";
+    std::cout << "  pooled layout:      " << kb(newCustRecords) << " KB records + "
+              << kb(custText) << " KB in the pool, no per-field allocations\n";
+
+    std::cout << "Maintenance records: " << maintenanceLogs.size() << "\n";
+    std::cout << "  std::string layout: " << kb(oldMaintRecords) << " KB records + "
+              << kb(maintHeap) << " KB heap in " << maintAllocs << " allocations\n";
+    std::cout << "  interned layout:    " << kb(newMaintRecords) << " KB records + "
+              << kb(maintDistinct) << " KB for " << distinct.size() << " distinct values\n";
+
+    std::cout << "String pool: " << ps.blocks << " blocks, " << kb(ps.bytesReserved) << " KB reserved, "
+              << kb(ps.bytesUsed) << " KB used, " << ps.interned << " interned values ("
+              << ps.internHits << " hits), intern table ~" << kb(ps.internTableBytes) << " KB\n";
+
+    std::cout << "Total: " << kb(oldTotal) << " KB as std::string, " << kb(newTotal) << " KB pooled\n";
+    std::cout << std::defaultfloat << std::setprecision(6);
+}
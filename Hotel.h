@@ -6,51 +6,274 @@
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <unordered_map>
+#include <mutex>
+#include <shared_mutex>
+#include <optional>
+#include <atomic>
+#include <future>
+#include <chrono>
 
 #include "Room.h"
 #include "RoomType.h"
 #include "Customer.h"
 #include "Booking.h"
 #include "Payment.h"
+#include "PaymentLedger.h"
 #include "Maintenance.h"
 #include "Staff.h"
+#include "StringPool.h"
+#include "CustomerIndex.h"
+#include "Journal.h"
+#include "Trace.h"
+#include "Generations.h"
+#include "InvoiceQueue.h"
+#include "Snapshot.h"
+#include "HotelStats.h"
+#include "OccupancySeries.h"
+#include "RateEngine.h"
+#include "MaintenanceQueue.h"
+#include "RoomCalendar.h"
+#include "CowTable.h"
+#include "Date.h"
+
+class JsonWriter;
+namespace bulk {
+struct Batch;
+enum class Format;
+}
+
+// Consistent point-in-time copy of the tables, for reports that must
+// not hold the table lock while they run (see Hotel::pinView). Text
+// fields point into the Hotel's string pool, so a view must not
+// outlive its Hotel. Payments are append-only, so the view keeps only
+// a row count and the columnar ledger is summed up to it.
+struct HotelView {
+    CowTable<Room>::View rooms;
+    CowTable<Customer>::View customers;
+    CowTable<Booking>::View bookings;
+    size_t paymentRows = 0;
+    std::vector<RoomType> roomTypes;
+    HotelStats stats;
+
+    const RoomType* roomType(int typeId) const {
+        for (const auto& rt : roomTypes)
+            if (rt.typeId == typeId) return &rt;
+        return nullptr;
+    }
+};
 
 class Hotel {
 private:
+    // Directory holding this property's files (generations, journal
+    // segments, invoices, dashboard exports); empty for the working
+    // directory
+    const std::string dataDir;
+    std::string dataPath(const char* file) const;
+    // Metrics property of the thread that loaded it (see Metrics.h)
+    const std::string metricsProperty;
+
+    // The table files live in checksummed generations under dataDir
+    // (Generations.h); tablePath() names a file in the current one
+    GenerationStore generations;
+    std::string tablePath(const char* file) const;
+
+    // tableMutex guards every table, index, pool and aggregate below:
+    // shared for reads, exclusive for changes. A room's stripe lock is
+    // held across its whole transition including the durable write,
+    // so the journal sees each room's changes in order. persistMutex
+    // serialises file writes. Lock order: stripe, lazyMutex,
+    // persistMutex, tableMutex.
+    mutable std::shared_mutex tableMutex;
+    std::mutex persistMutex;
+    static constexpr size_t ROOM_STRIPES = 64;
+    std::mutex roomStripes[ROOM_STRIPES];
+
+    std::mutex& roomStripe(int roomId) { return roomStripes[(size_t)roomId % ROOM_STRIPES]; }
+
     std::vector<RoomType> roomTypes;
     std::vector<Room> rooms;
     std::vector<Customer> customers;
     std::vector<Booking> bookings;
-    std::vector<Payment> payments;
+    PaymentLedger payments;      // columnar, see PaymentLedger.h
     std::vector<Maintenance> maintenanceLogs;
     std::vector<Staff> staff;
 
+    // Backs the text fields of customers and maintenance records
+    StringPool strings;
+
+    // ID -> slot in the matching vector. The vectors are append-only,
+    // so a slot stays valid for the lifetime of the Hotel.
+    std::unordered_map<int, size_t> roomTypeIndex;
+    std::unordered_map<int, size_t> roomIndex;
+    std::unordered_map<int, size_t> customerIndex;
+    std::unordered_map<int, size_t> bookingIndex;
+    std::unordered_map<int, size_t> paymentIndex;
+    std::unordered_map<int, size_t> maintIndex;
+
+    // Phone / email / name-prefix lookups over customers
+    CustomerIndex customerLookup;
+    bool dedupCustomers = false;
+
+    void rebuildIndexes();
+    const RoomType* roomTypeById(int id) const;
+    int roomOfBooking(int bookingId) const;
+
+    // Per-type pools of Available room slots. freePos[slot] is the
+    // slot's position inside its pool (NOT_FREE otherwise), so rooms
+    // can be added and removed in O(1) by swap-and-pop.
+    static constexpr size_t NOT_FREE = (size_t)-1;
+    std::unordered_map<int, std::vector<size_t>> freeRooms;
+    std::vector<size_t> freePos;
+
+    // Reserved stays per room slot, and room slots per type, for
+    // date-range availability
+    std::vector<RoomCalendar> calendars;
+    std::unordered_map<int, std::vector<size_t>> roomsByType;
+
+    void rebuildCalendars();
+    void settleRoomStatus(Room& r);
+    bool roomTaken(const Room& r, int day) const;
+    std::atomic<int> statusDay{0};   // the day Booked was last derived for
+
+    void poolInsert(size_t slot);
+    void poolRemove(size_t slot);
+    void rebuildFreePools();
+
+    // Dashboard aggregates, see HotelStats.h
+    HotelStats stats;
+
+    void rebuildStats();
+    void rebuildPaymentStats();
+
+    // Daily occupancy and revenue per room type, see OccupancySeries.h
+    OccupancySeries occupancy;
+    void rebuildOccupancy();
+    void placePayments();
+    // occupancySeries / occupancyTotal without the trace record
+    std::vector<OccupancyPoint> readOccupancySeries(int typeId, int from, int to, Resolution step) const;
+    OccupancyPoint readOccupancyTotal(int typeId, int from, int to) const;
+    double bookingEstimate(const Booking& b) const;
+
+    // Nightly price tables from rates.conf, see RateEngine.h; rebuilt
+    // with the occupancy series and refreshed with every stay change
+    RateEngine rates;
+    void rebuildRates();
+    double quoteRoom(const Room& r, int checkIn, int nights) const;
+
+    // Open maintenance jobs and idle technicians, see MaintenanceQueue.h;
+    // rebuilt from maintenanceLogs and staff after a load
+    MaintenanceQueue maintQueue;
+    void rebuildMaintenanceQueue();
+
+    // Copy-on-write mirrors of the tables behind pinView(), updated
+    // with every change below and rebuilt after a load or import
+    CowTable<Room> roomVersions;
+    CowTable<Customer> customerVersions;
+    CowTable<Booking> bookingVersions;
+
+    void rebuildVersions();
+
+    // Every room and booking status change goes through these to keep
+    // the pools, the aggregates and the versioned tables in step
+    void setRoomStatus(Room& r, RoomStatus s);
+    void setBookingStatus(Booking& b, BookingStatus s);
+    void recordPayment(const Payment& p, int roomTypeId);
+
     int nextRoomId  = 1;
     int nextCustomerId = 1;
     int nextBookingId  = 1;
     int nextPaymentId  = 1;
     int nextMaintId    = 1;
+    int nextStaffId    = 1;
 
     const double TAX_RATE = 0.18;
 
-    // Persistence helpers
-    void saveRooms();
-    void saveCustomers();
-    void saveBookings();
-    void savePayments();
-    void saveMaintenance();
-    
+    // Write-ahead journal (journal mode only)
+    Journal journal;
+    bool journalEnabled = false;
+    size_t checkpointEvery = 1000;
+
+    bool commit(const JournalEntry& e);
+
+    // Command trace of the public API calls (off unless started)
+    mutable trace::Recorder tracer;
+    // Writes and commits a new generation, then moves the journal on
+    // to a segment based on it
+    bool saveTables();
+    void applyJournalEntry(const std::vector<std::string>& f);
+    size_t replayJournal(const std::vector<std::string>& segments);
+    std::string journalSegment(uint64_t base) const;
+    std::vector<uint64_t> journalSegments() const;
+    void adoptLegacyJournal();
+    void rotateJournal();
+
+    // Persistence helpers, each writing one table file
+    bool saveRooms(const std::string& path);
+    bool saveCustomers(const std::string& path);
+    bool saveBookings(const std::string& path);
+    bool savePayments(const std::string& path);
+    bool saveMaintenance(const std::string& path);
+    // Staff is kept in staff.dat in both storage formats
+    bool saveStaff(const std::string& path);
+    void loadStaff();
+
     void loadRooms();
     void loadCustomers();
     void loadBookings();
-    void loadPayments();
-    void loadMaintenance();
+    bool loadPayments(PaymentLedger& out, int& nextId);
+    bool loadMaintenance(std::vector<Maintenance>& out, int& nextId);
+
+    // Checkout invoices, written in the background
+    InvoiceQueue invoices;
+
+    // After a .dat start-up, payments and maintenance history are read
+    // on a background thread. Everything that touches them calls
+    // awaitLazyTables() first, before taking any other lock.
+    mutable std::mutex lazyMutex;
+    mutable std::atomic<bool> lazyPending{false};
+    PaymentLedger lazyPayments;
+    std::vector<Maintenance> lazyMaintenance;
+    int lazyNextPaymentId = 1;
+    int lazyNextMaintId = 1;
+    bool lazyHavePayments = false;
+    bool lazyHaveMaintenance = false;
+    std::future<void> lazyLoad;   // declared last: joins before the tables go
+
+    void startLazyLoad();
+    void awaitLazyTables() const;
+    void adoptLazyTables();
+
+    // Binary snapshot (hotel.snap); used instead of the .dat files
+    // once the snapshot exists
+    bool binarySnapshots = false;
+    bool saveSnapshot(const std::string& path);
+    bool loadSnapshot();
 
 public:
-    Hotel();
-    
+    // Loads the property stored in dataDir (created if missing). Throws
+    // std::runtime_error when its committed generations are all damaged.
+    explicit Hotel(const std::string& dataDir = "");
+    const std::string& getDataDir() const { return dataDir; }
+
+    // Changes are durable (journal or full save) before a call returns
+    // success. If neither succeeds the call reports failure: -3 from
+    // the ID-returning calls, false from the others, with
+    // lastChangeUnsaved() set for the calling thread. The change stays
+    // in memory and goes out with the next successful save.
+    static bool lastChangeUnsaved();
+
+    // All public members are safe to call from several threads, except
+    // the ones returning raw pointers or references into the tables
+    // (findRoom, findBooking, getRooms, ...), which must not race with
+    // writers. Concurrent callers should use getRoom()/getBooking().
+
     // Add to public section of Hotel class
-    void exportToJSON();
+    // A relative path is under the data directory
+    bool exportToJSON(const std::string& path = "dashboard/dashboard_data.json",
+                      bool atomic = true);
+    std::string dashboardJSON() const;
+    void writeDashboardJSON(JsonWriter& w) const;
     void generateDashboardHTML();
 
     // Initialization helpers
@@ -59,15 +282,40 @@ public:
     // RoomType & Room management
     void addRoomType(const RoomType& rt);
     const RoomType* getRoomTypeById(int id) const;
-    void addRoom(int typeId, double customPrice = 0.0);
+    // Returns the new room's ID
+    int addRoom(int typeId, double customPrice = 0.0);
     Room* findRoom(int roomId);
     const std::vector<Room>& getRooms() const { return rooms; }
+    const std::vector<RoomType>& getRoomTypes() const { return roomTypes; }
+    size_t freeRoomCount(int typeId) const;
+    std::optional<Room> getRoom(int roomId) const;
 
     // Customer & booking
+    // With dedup on, a guest whose email or phone is already on file
+    // gets the existing customer ID back instead of a new record
     int addCustomer(const std::string& name, const std::string& phone, const std::string& email);
+    void setCustomerDedup(bool on);
+    // Guests matching every non-empty field of the query, by ID
+    std::vector<Customer> findCustomers(const CustomerQuery& q) const;
+    // Stay starting today
     int createBooking(int custId, int roomId, int days);
+    // Stay over [checkIn, checkIn + nights) (day numbers, see Date.h);
+    // returns the booking ID, -1 for bad input or -2 if the room is taken
+    int createReservation(int custId, int roomId, int checkIn, int nights);
+    // Books any Available room of the given type; returns the booking ID,
+    // -1 for an unknown type or -2 when no room of that type is free
+    int bookAnyRoom(int custId, int typeId, int days);
+    // Rooms of a type with no reservation overlapping [from, to)
+    std::vector<int> findAvailableRooms(int typeId, int from, int to) const;
     bool cancelBooking(int bookingId);
+    // Room charge for a stay under the rate plan, before extras and tax;
+    // negative for an unknown room / type or nights < 1
+    double quoteStay(int roomId, int checkIn, int nights) const;
+    double quoteType(int typeId, int checkIn, int nights) const;
+    // Replaces the rate plan (without touching rates.conf)
+    void setRatePlan(const RatePlan& plan);
     Booking* findBooking(int bookingId);
+    std::optional<Booking> getBooking(int bookingId) const;
 
     const std::vector<Customer>& getCustomers() const { return customers; }
     const std::vector<Booking>& getBookings() const { return bookings; }
@@ -76,22 +324,102 @@ public:
     bool hasCustomer(int custId) const;
     bool hasBooking(int bookingId) const;
 
-    void checkoutBooking(int bookingId, double extraCharges);
+    // The invoice is queued and written in the background
+    bool checkoutBooking(int bookingId, double extraCharges);
+
+    // Waits until every queued checkout invoice is on disk
+    void flushInvoices();
+    // Batch invoicing: writes the invoices of the given checked-out
+    // bookings into dir in parallel, with an index.csv; returns how many
+    size_t writeInvoices(const std::vector<int>& bookingIds, const std::string& dir);
+    // End of day: every booking paid on the given day (Date.h day number)
+    size_t writeInvoicesForDay(int day, const std::string& dir);
+
+    // Maintenance. A job dated today or earlier takes the room out of
+    // service at once; a later one when a technician starts it. Returns
+    // the job ID, -1 for an unknown room or bad date, -2 if the room is
+    // booked on the job's day (today for overdue work). Idle technicians
+    // are dispatched straight away.
+    int scheduleMaintenance(int roomId, const std::string& issue, const std::string& date,
+                            MaintPriority priority = MaintPriority::Normal);
+    // Starts ready jobs, most urgent first, while technicians are idle;
+    // jobs whose room has a guest in it wait. Returns the jobs started,
+    // or -3 if any start could not be saved.
+    int dispatchMaintenance();
+    // Frees the technician and, with no other job on the room, puts the
+    // room back into use; then dispatches the next job
+    bool completeMaintenance(int maintId);
+    // Scheduled and in-progress jobs, by priority and due day
+    std::vector<Maintenance> openMaintenance() const;
+    // Takes a room out of service by hand, or puts it back. Returns 1 if
+    // it went into maintenance, 0 if it came back into use, -1 for an
+    // unknown room, -2 if it is booked today, -3 if the change could not
+    // be saved, and -4 while a maintenance job holds the room (complete
+    // the job instead).
+    int toggleRoomMaintenance(int roomId);
+
+    // Staff; role "Technician" takes maintenance jobs
+    int addStaff(const std::string& name, const std::string& role, double salary);
+    std::vector<Staff> getStaff() const;
 
-    // Maintenance
-    void scheduleMaintenance(int roomId, const std::string& issue, const std::string& date);
-    void toggleRoomMaintenance(int roomId);
+    // Marks rooms Booked whose reservation has started since the last
+    // pass; a no-op until the date changes. Booking and maintenance calls
+    // run it themselves; long-running front ends call it per request.
+    void rollOverDay();
 
     // Reports
     int countAvailableRooms() const;
     int countBookedRooms() const;
     int countMaintenanceRooms() const;
     double estimatedRevenueActive() const;
+    double completedRevenue() const;
+    // Revenue per calendar month over [from, to) as (YYYYMM, amount),
+    // from the columnar payment ledger
+    std::vector<std::pair<int, double>> revenueByMonth(int from, int to) const;
+    // Occupancy, ADR and RevPAR over [from, to) for a room type (0 for
+    // all types), from the maintained time series
+    std::vector<OccupancyPoint> occupancySeries(int typeId, int from, int to, Resolution step) const;
+    OccupancyPoint occupancyTotal(int typeId, int from, int to) const;
+
+    // Pins the current tables and aggregates in O(1) (plus the room
+    // types and per-type revenue); writers carry on while the view is read
+    HotelView pinView() const;
 
     // Persistence
     void saveAll();
     void loadAll();
 
+    // Journal mode: mutations append to a journal segment instead of
+    // rewriting every .dat file; checkpoint() folds them into a new
+    // generation and starts the next segment.
+    void enableJournal(size_t checkpointInterval = 1000, bool sync = true);
+    // Journal mode with group commit: concurrent mutations are batched
+    // into one write + fdatasync, flushed after window or maxBatch
+    // records, and each call returns once its batch is durable
+    void enableGroupCommit(std::chrono::microseconds window = std::chrono::microseconds(200),
+                           size_t maxBatch = 256, size_t checkpointInterval = 100000);
+    bool isJournalEnabled() const { return journalEnabled; }
+    void checkpoint();
+
+    // Records the public API calls into a trace file (Trace.h lists the
+    // ones left out) until stopTrace(); replay it with bench/hotel_replay
+    bool startTrace(const std::string& path) { return tracer.start(path); }
+    void stopTrace() { tracer.stop(); }
+
+    // Switch storage to the binary hotel.snap format, writing the
+    // current (.dat loaded) state into it
+    bool convertToBinarySnapshot();
+    bool isBinarySnapshot() const { return binarySnapshots; }
+
+    // Bulk onboarding, see BulkIO.h. Adds every row of the batch whose
+    // ID is new and whose references (typeId, custId, roomId) resolve,
+    // and rejects the rest into batch.errors. Indexes and aggregates are
+    // rebuilt once, and a single hotel.snap is written (storage switches
+    // to the binary snapshot, which keeps text with spaces intact).
+    bool importBatch(bulk::Batch& batch);
+    // rooms, customers and bookings files in dir, as CSV or NDJSON
+    bool exportTables(const std::string& dir, bulk::Format format) const;
+
     // Utilities
     void printRooms() const;
     void printCustomers() const;
@@ -103,6 +431,13 @@ public:
     void printRoomsReport();
     void printCustomerReport();
     void printRevenueReport();
+    // Per type over the last 365 days, then month by month
+    void printOccupancyReport();
+    // Open jobs with their SLA state, and what each technician is on
+    void printMaintenanceQueue();
+    // Customer and maintenance text storage: the former std::string
+    // layout (estimated) against the string pool
+    void printMemoryReport();
 };
 
 #endif
@@ -0,0 +1,26 @@
+#ifndef HOTELSTATS_H
+#define HOTELSTATS_H
+
+#include <unordered_map>
+#include "COMMON.h"
+#include "Booking.h"
+
+// Running totals maintained on every room, booking and payment
+// transition, so reports never have to rescan the tables.
+class HotelStats {
+public:
+    int roomStatus[3] = { 0, 0, 0 };      // indexed by RoomStatus
+    int bookingStatus[3] = { 0, 0, 0 };   // indexed by BookingStatus
+    double completedRevenue = 0.0;        // sum of Payment::total()
+    // Quoted Booking::amount of Confirmed bookings (basePrice * days for
+    // bookings saved before quotes were stored)
+    double estimatedActive = 0.0;
+    std::unordered_map<int, double> typeRevenue;   // typeId -> completed revenue
+
+    int rooms(RoomStatus s) const { return roomStatus[(int)s]; }
+    int bookings(BookingStatus s) const { return bookingStatus[(int)s]; }
+
+    void clear() { *this = HotelStats(); }
+};
+
+#endif
@@ -0,0 +1,731 @@
+#include "HttpServer.h"
+#include "Hotel.h"
+#include "JsonWriter.h"
+#include "Metrics.h"
+
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static const size_t MAX_HEADER_BYTES = 64 * 1024;
+static const size_t MAX_BODY_BYTES = 1024 * 1024;
+// The most one connection buffers before its requests are answered
+static const size_t MAX_REQUEST_BYTES = MAX_HEADER_BYTES + 4 + MAX_BODY_BYTES;
+// Unsent responses past this stop the connection being read until the
+// client takes them
+static const size_t MAX_PENDING_OUT = 1024 * 1024;
+
+/* ================= Helpers ================= */
+
+static std::string lower(std::string s) {
+    for (auto& c : s) c = (char)std::tolower((unsigned char)c);
+    return s;
+}
+
+static std::string urlDecode(const std::string& s) {
+    std::string out;
+    for (size_t i = 0; i < s.size(); i++) {
+        if (s[i] == '+') {
+            out += ' ';
+        } else if (s[i] == '%' && i + 2 < s.size()) {
+            out += (char)std::strtol(s.substr(i + 1, 2).c_str(), nullptr, 16);
+            i += 2;
+        } else {
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+static void parseParams(const std::string& s, std::map<std::string, std::string>& out) {
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t amp = s.find('&', pos);
+        if (amp == std::string::npos) amp = s.size();
+
+        std::string pair = s.substr(pos, amp - pos);
+        size_t eq = pair.find('=');
+        if (eq != std::string::npos)
+            out[urlDecode(pair.substr(0, eq))] = urlDecode(pair.substr(eq + 1));
+        else if (!pair.empty())
+            out[urlDecode(pair)] = "";
+
+        pos = amp + 1;
+    }
+}
+
+static const char* reason(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 503: return "Service Unavailable";
+    }
+    return "Error";
+}
+
+static HttpServer::Response json(int status, const std::string& body) {
+    HttpServer::Response r;
+    r.status = status;
+    r.body = body;
+    return r;
+}
+
+// One writer per worker thread, reused for every response it builds
+static thread_local JsonWriter out;
+
+static HttpServer::Response error(int status, const std::string& msg) {
+    out.clear();
+    out.beginObject().field("error", msg).endObject();
+    return json(status, out.str());
+}
+
+static bool readFile(const std::string& path, std::string& out) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    out.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static bool toInt(const std::string* s, int& v) {
+    if (!s || s->empty()) return false;
+    char* end;
+    errno = 0;
+    long n = std::strtol(s->c_str(), &end, 10);
+    if (*end || errno == ERANGE || n < INT_MIN || n > INT_MAX) return false;
+    v = (int)n;
+    return true;
+}
+
+// An optional parameter: absent leaves v as it is, malformed fails
+static bool optInt(const std::string* s, int& v) {
+    return !s || toInt(s, v);
+}
+
+// A non-negative, finite amount of money
+static bool toAmount(const std::string* s, double& v) {
+    if (!s || s->empty()) return false;
+    char* end;
+    errno = 0;
+    double d = std::strtod(s->c_str(), &end);
+    if (*end || errno == ERANGE || !std::isfinite(d) || d < 0) return false;
+    v = d;
+    return true;
+}
+
+const std::string* HttpServer::Request::param(const std::string& name) const {
+    auto it = params.find(name);
+    return (it != params.end()) ? &it->second : nullptr;
+}
+
+/* ================= Routing ================= */
+
+static const std::string& bookingJSON(const Booking& b) {
+    out.clear();
+    out.beginObject()
+        .field("bookingId", b.bookingId)
+        .field("custId", b.custId)
+        .field("roomId", b.roomId)
+        .field("roomTypeId", b.roomTypeId)
+        .field("checkIn", b.checkIn ? formatDate(b.checkIn) : "")
+        .field("days", b.days)
+        .field("status", (int)b.status)
+        .field("amount", b.amount)
+        .endObject();
+    return out.str();
+}
+
+static void maintenanceJSON(const Maintenance& m) {
+    out.beginObject()
+        .field("maintId", m.maintId)
+        .field("roomId", m.roomId)
+        .field("issue", m.issue)
+        .field("priority", MAINT_PRIORITY[(int)m.priority])
+        .field("day", m.day ? formatDate(m.day) : "")
+        .field("due", formatDate(m.dueDay))
+        .field("status", (int)m.status)
+        .field("staffId", m.staffId)
+        .endObject();
+}
+
+HttpServer::Response HttpServer::handle(const Request& req) {
+    const std::string& path = req.path;
+    bool get = req.method == "GET";
+    bool post = req.method == "POST";
+    hotel.rollOverDay();
+
+    if (path == "/api/dashboard" || path == "/dashboard_data.json") {
+        if (!get) return error(405, "use GET");
+        out.clear();
+        hotel.writeDashboardJSON(out);
+        return json(200, out.str());
+    }
+
+    if (path == "/metrics") {
+        if (!get) return error(405, "use GET");
+        if (!metrics::enabled()) return error(404, "metrics are compiled out");
+
+        Response r;
+        r.contentType = "text/plain; version=0.0.4";
+        r.body = metrics::prometheusText();
+        return r;
+    }
+
+    if (path == "/" || path == "/dashboard.html") {
+        Response r;
+        r.contentType = "text/html; charset=utf-8";
+        if (!readFile("dashboard/dashboard.html", r.body) && !readFile("dashboard.html", r.body))
+            return error(404, "dashboard.html not found");
+        return r;
+    }
+
+    if (path == "/api/rooms/available") {
+        int typeId, from, to;
+        const std::string* f = req.param("from");
+        const std::string* t = req.param("to");
+        if (!toInt(req.param("typeId"), typeId) || !f || !t ||
+            !parseDate(*f, from) || !parseDate(*t, to))
+            return error(400, "typeId, from and to are required");
+
+        out.clear();
+        out.beginObject().key("rooms").beginArray();
+        for (int id : hotel.findAvailableRooms(typeId, from, to)) out.value(id);
+        out.endArray().endObject();
+        return json(200, out.str());
+    }
+
+    if (path == "/api/occupancy") {
+        if (!get) return error(405, "use GET");
+        // Defaults: every type, the last 365 days, by month
+        int typeId = 0, to = today() + 1, from = to - 365;
+        if (!optInt(req.param("typeId"), typeId)) return error(400, "typeId must be a number");
+        const std::string* f = req.param("from");
+        const std::string* t = req.param("to");
+        if ((f && !parseDate(*f, from)) || (t && !parseDate(*t, to)) || from >= to)
+            return error(400, "from and to must be YYYY-MM-DD with from < to");
+
+        Resolution step = Resolution::Month;
+        if (const std::string* s = req.param("step")) {
+            if (*s == "day") step = Resolution::Day;
+            else if (*s == "week") step = Resolution::Week;
+            else if (*s != "month") return error(400, "step is day, week or month");
+        }
+        if (step == Resolution::Day && to - from > 3660) return error(400, "at most 10 years by day");
+
+        out.clear();
+        OccupancyPoint all = hotel.occupancyTotal(typeId, from, to);
+        out.beginObject()
+            .field("occupancy", all.occupancy())
+            .field("adr", all.adr())
+            .field("revpar", all.revpar())
+            .field("revenue", all.revenue);
+        out.key("points").beginArray();
+        for (const auto& p : hotel.occupancySeries(typeId, from, to, step)) {
+            out.beginObject()
+                .field("start", formatDate(p.start))
+                .field("days", p.days)
+                .field("roomNights", p.roomNights)
+                .field("occupancy", p.occupancy())
+                .field("adr", p.adr())
+                .field("revpar", p.revpar())
+                .field("revenue", p.revenue)
+                .field("arrivals", p.arrivals)
+                .field("departures", p.departures)
+                .field("cancellations", p.cancellations)
+                .endObject();
+        }
+        out.endArray().endObject();
+        return json(200, out.str());
+    }
+
+    if (path == "/api/quote") {
+        if (!get) return error(405, "use GET");
+        int roomId, typeId, nights, checkIn = today();
+        const std::string* c = req.param("checkIn");
+        if ((c && !parseDate(*c, checkIn)) || !toInt(req.param("nights"), nights) || nights < 1)
+            return error(400, "nights must be at least 1, checkIn YYYY-MM-DD");
+
+        double amount;
+        const std::string* room = req.param("roomId");
+        const std::string* type = req.param("typeId");
+        if (room && toInt(room, roomId)) amount = hotel.quoteStay(roomId, checkIn, nights);
+        else if (!room && toInt(type, typeId)) amount = hotel.quoteType(typeId, checkIn, nights);
+        else return error(400, "roomId or typeId is required");
+        if (amount < 0) return error(404, "unknown room or type");
+
+        out.clear();
+        out.beginObject()
+            .field("checkIn", formatDate(checkIn))
+            .field("nights", nights)
+            .field("amount", amount)
+            .field("perNight", amount / nights)
+            .endObject();
+        return json(200, out.str());
+    }
+
+    if (path == "/api/customers" && get) {
+        CustomerQuery q;
+        if (const std::string* v = req.param("phone")) q.phone = *v;
+        if (const std::string* v = req.param("email")) q.email = *v;
+        if (const std::string* v = req.param("name")) q.namePrefix = *v;
+        int limit = 1;
+        if (!optInt(req.param("limit"), limit) || limit < 1) return error(400, "limit must be at least 1");
+        if (req.param("limit")) q.limit = (size_t)limit;
+        if (q.phone.empty() && q.email.empty() && q.namePrefix.empty())
+            return error(400, "phone, email or name is required");
+
+        out.clear();
+        out.beginObject().key("customers").beginArray();
+        for (const Customer& c : hotel.findCustomers(q)) {
+            out.beginObject()
+                .field("custId", c.custId)
+                .field("name", c.name)
+                .field("phone", c.phone)
+                .field("email", c.email)
+                .endObject();
+        }
+        out.endArray().endObject();
+        return json(200, out.str());
+    }
+
+    if (path == "/api/customers") {
+        if (!post) return error(405, "use POST");
+
+        const std::string* name = req.param("name");
+        const std::string* phone = req.param("phone");
+        const std::string* email = req.param("email");
+        if (!name || !phone || !email || name->empty())
+            return error(400, "name, phone and email are required");
+
+        int id = hotel.addCustomer(*name, *phone, *email);
+        if (id == -3) return error(503, "change could not be saved");
+        out.clear();
+        out.beginObject().field("custId", id).endObject();
+        return json(201, out.str());
+    }
+
+    if (path == "/api/bookings") {
+        if (!post) return error(405, "use POST");
+
+        int custId, roomId, typeId, days, nights, checkIn;
+        if (!toInt(req.param("custId"), custId) || !hotel.hasCustomer(custId))
+            return error(404, "unknown custId");
+
+        bool dated = req.param("checkIn") != nullptr;
+        if (dated) {
+            if (!parseDate(*req.param("checkIn"), checkIn) || !toInt(req.param("nights"), nights))
+                return error(400, "checkIn needs YYYY-MM-DD and nights");
+        } else if (!toInt(req.param("days"), days) || days < 1) {
+            return error(400, "days must be at least 1");
+        }
+
+        int bid;
+        const std::string* room = req.param("roomId");
+        if (room && toInt(room, roomId)) {
+            bid = dated ? hotel.createReservation(custId, roomId, checkIn, nights)
+                        : hotel.createBooking(custId, roomId, days);
+        } else if (!room && toInt(req.param("typeId"), typeId) && !dated) {
+            bid = hotel.bookAnyRoom(custId, typeId, days);
+        } else {
+            return error(400, "roomId (or typeId with days) is required");
+        }
+
+        if (bid == -2) return error(409, "room not available");
+        if (bid == -3) return error(503, "change could not be saved");
+        if (bid < 0) return error(400, "invalid booking");
+
+        auto b = hotel.getBooking(bid);
+        return json(201, b ? bookingJSON(*b) : "{}");
+    }
+
+    if (path == "/api/maintenance") {
+        if (get) {
+            out.clear();
+            out.beginArray();
+            for (const auto& m : hotel.openMaintenance()) maintenanceJSON(m);
+            out.endArray();
+            return json(200, out.str());
+        }
+        if (!post) return error(405, "use GET or POST");
+
+        int roomId;
+        const std::string* issue = req.param("issue");
+        if (!toInt(req.param("roomId"), roomId) || !hotel.hasRoom(roomId)) return error(404, "unknown roomId");
+        if (!issue || issue->empty()) return error(400, "issue is required");
+        std::string date = formatDate(today());
+        if (const std::string* d = req.param("date")) date = *d;
+        MaintPriority priority = MaintPriority::Normal;
+        if (const std::string* p = req.param("priority"))
+            if (!parsePriority(*p, priority)) return error(400, "priority is urgent, high, normal or low");
+
+        int id = hotel.scheduleMaintenance(roomId, *issue, date, priority);
+        if (id == -2) return error(409, "room is booked");
+        if (id == -3) return error(503, "change could not be saved");
+        if (id < 0) return error(400, "date must be YYYY-MM-DD");
+        out.clear();
+        out.beginObject().field("maintId", id).endObject();
+        return json(201, out.str());
+    }
+
+    // Starts jobs whose day has come; a GET of the queue leaves it alone
+    if (path == "/api/maintenance/dispatch") {
+        if (!post) return error(405, "use POST");
+        int started = hotel.dispatchMaintenance();
+        if (started == -3) return error(503, "change could not be saved");
+        out.clear();
+        out.beginObject().field("started", started).endObject();
+        return json(200, out.str());
+    }
+
+    if (path.compare(0, 17, "/api/maintenance/") == 0) {
+        std::string rest = path.substr(17);
+        size_t slash = rest.find('/');
+        std::string idText = rest.substr(0, slash);
+        int id;
+        if (!toInt(&idText, id) || slash == std::string::npos || rest.substr(slash + 1) != "complete")
+            return error(404, "no such endpoint");
+        if (!post) return error(405, "use POST");
+        if (!hotel.completeMaintenance(id))
+            return Hotel::lastChangeUnsaved() ? error(503, "change could not be saved")
+                                              : error(409, "job is not in progress");
+        out.clear();
+        out.beginObject().field("maintId", id).field("completed", true).endObject();
+        return json(200, out.str());
+    }
+
+    if (path.compare(0, 14, "/api/bookings/") == 0) {
+        std::string rest = path.substr(14);
+        size_t slash = rest.find('/');
+        std::string action = (slash == std::string::npos) ? "" : rest.substr(slash + 1);
+
+        int bid;
+        std::string idText = rest.substr(0, slash);
+        if (!toInt(&idText, bid) || !hotel.hasBooking(bid)) return error(404, "unknown booking");
+
+        if (action.empty()) {
+            if (!get) return error(405, "use GET");
+            return json(200, bookingJSON(*hotel.getBooking(bid)));
+        }
+
+        if (!post) return error(405, "use POST");
+
+        if (action == "cancel") {
+            if (!hotel.cancelBooking(bid))
+                return Hotel::lastChangeUnsaved() ? error(503, "change could not be saved")
+                                                  : error(409, "booking is not active");
+            return json(200, bookingJSON(*hotel.getBooking(bid)));
+        }
+
+        if (action == "checkout") {
+            double extra = 0.0;
+            const std::string* e = req.param("extra");
+            if (e && !toAmount(e, extra)) return error(400, "extra must be a non-negative amount");
+            if (!hotel.checkoutBooking(bid, extra))
+                return Hotel::lastChangeUnsaved() ? error(503, "change could not be saved")
+                                                  : error(409, "booking is not active");
+            return json(200, bookingJSON(*hotel.getBooking(bid)));
+        }
+    }
+
+    return error(404, "no such endpoint");
+}
+
+/* ================= Request Parsing ================= */
+
+int HttpServer::process(Connection& c) {
+    if (c.outPos > 0) {
+        c.out.erase(0, c.outPos);
+        c.outPos = 0;
+    }
+
+    // A client that does not read its responses gets no more of them
+    while (!c.closeAfterWrite && c.pending() <= MAX_PENDING_OUT) {
+        size_t headerEnd = c.in.find("\r\n\r\n");
+        if (headerEnd == std::string::npos) return c.in.size() > MAX_HEADER_BYTES ? 431 : 0;
+        if (headerEnd > MAX_HEADER_BYTES) return 431;
+
+        std::istringstream head(c.in.substr(0, headerEnd));
+        std::string line, target, version;
+        Request req;
+
+        std::getline(head, line);
+        std::istringstream first(line);
+        if (!(first >> req.method >> target >> version)) return 400;
+
+        size_t contentLength = 0;
+        req.keepAlive = (version == "HTTP/1.1");
+
+        while (std::getline(head, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) continue;
+
+            std::string name = lower(line.substr(0, colon));
+            std::string value = line.substr(colon + 1);
+            value.erase(0, value.find_first_not_of(' '));
+
+            if (name == "content-length") {
+                contentLength = (size_t)std::strtoul(value.c_str(), nullptr, 10);
+            } else if (name == "connection") {
+                std::string v = lower(value);
+                if (v == "close") req.keepAlive = false;
+                else if (v == "keep-alive") req.keepAlive = true;
+            }
+        }
+
+        if (contentLength > MAX_BODY_BYTES) return 413;
+        size_t total = headerEnd + 4 + contentLength;
+        if (c.in.size() < total) return 0;
+
+        size_t q = target.find('?');
+        req.path = target.substr(0, q);
+        if (q != std::string::npos) parseParams(target.substr(q + 1), req.params);
+        parseParams(c.in.substr(headerEnd + 4, contentLength), req.params);
+        c.in.erase(0, total);
+
+        Response res = handle(req);
+
+        std::ostringstream o;
+        o << "HTTP/1.1 " << res.status << " " << reason(res.status) << "\r\n"
+          << "Content-Type: " << res.contentType << "\r\n"
+          << "Content-Length: " << res.body.size() << "\r\n"
+          << "Connection: " << (req.keepAlive ? "keep-alive" : "close") << "\r\n\r\n";
+        c.out += o.str();
+        c.out += res.body;
+
+        if (!req.keepAlive) c.closeAfterWrite = true;
+    }
+    return 0;
+}
+
+/* ================= Event Loop ================= */
+
+HttpServer::HttpServer(Hotel& h, int p, int threads)
+    : hotel(h), port(p),
+      threadCount(threads > 0 ? threads : (int)std::max(1u, std::thread::hardware_concurrency())) {}
+
+HttpServer::~HttpServer() {
+    stop();
+}
+
+bool HttpServer::start() {
+    if (running) return true;
+    workers = std::vector<Worker>(threadCount);
+
+    for (auto& w : workers) {
+        w.listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        ::setsockopt(w.listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        ::setsockopt(w.listenFd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons((uint16_t)port);
+
+        if (::bind(w.listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(w.listenFd, 1024) != 0) {
+            std::cerr << "HTTP server cannot listen on port " << port << ": " << std::strerror(errno) << "\n";
+            stop();
+            return false;
+        }
+
+        w.epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        w.wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = w.listenFd;
+        ::epoll_ctl(w.epollFd, EPOLL_CTL_ADD, w.listenFd, &ev);
+        ev.data.fd = w.wakeFd;
+        ::epoll_ctl(w.epollFd, EPOLL_CTL_ADD, w.wakeFd, &ev);
+    }
+
+    running = true;
+    for (auto& w : workers) w.thread = std::thread(&HttpServer::loop, this, std::ref(w));
+    return true;
+}
+
+void HttpServer::stop() {
+    running = false;
+
+    for (auto& w : workers) {
+        if (w.wakeFd >= 0) {
+            uint64_t one = 1;
+            ssize_t n = ::write(w.wakeFd, &one, sizeof(one));
+            (void)n;
+        }
+    }
+
+    for (auto& w : workers) {
+        if (w.thread.joinable()) w.thread.join();
+        for (auto& c : w.conns) ::close(c.first);
+        w.conns.clear();
+        if (w.listenFd >= 0) ::close(w.listenFd);
+        if (w.epollFd >= 0) ::close(w.epollFd);
+        if (w.wakeFd >= 0) ::close(w.wakeFd);
+        w.listenFd = w.epollFd = w.wakeFd = -1;
+    }
+    workers.clear();
+}
+
+void HttpServer::loop(Worker& w) {
+    epoll_event events[256];
+
+    while (running) {
+        int n = ::epoll_wait(w.epollFd, events, 256, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+
+            if (fd == w.wakeFd) continue;
+            if (fd == w.listenFd) {
+                acceptAll(w);
+                continue;
+            }
+
+            auto it = w.conns.find(fd);
+            if (it == w.conns.end()) continue;
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConn(w, fd);
+                continue;
+            }
+            if (events[i].events & EPOLLIN) {
+                onReadable(w, fd);
+                continue;
+            }
+            // Requests held back while the client was not reading go
+            // once its responses drain
+            Connection& c = it->second;
+            if ((events[i].events & EPOLLOUT) && flush(w, fd, c) && !c.in.empty() &&
+                c.pending() <= MAX_PENDING_OUT)
+                serve(w, fd, c);
+        }
+    }
+}
+
+void HttpServer::acceptAll(Worker& w) {
+    while (true) {
+        int fd = ::accept4(w.listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        ::epoll_ctl(w.epollFd, EPOLL_CTL_ADD, fd, &ev);
+        w.conns[fd] = Connection();
+        w.conns[fd].events = EPOLLIN;
+    }
+}
+
+void HttpServer::onReadable(Worker& w, int fd) {
+    Connection& c = w.conns[fd];
+    char buf[16384];
+
+    // No more than one request's worth is read before answering
+    while (c.in.size() <= MAX_REQUEST_BYTES && c.pending() <= MAX_PENDING_OUT) {
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n > 0) {
+            c.in.append(buf, (size_t)n);
+            continue;
+        }
+        if (n == 0) {
+            c.peerClosed = true;
+            break;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN) break;
+
+        closeConn(w, fd);
+        return;
+    }
+    serve(w, fd, c);
+}
+
+void HttpServer::serve(Worker& w, int fd, Connection& c) {
+    bool heldBack;
+    do {
+        if (int status = process(c)) {
+            c.out += "HTTP/1.1 " + std::to_string(status) + " " + reason(status) +
+                     "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            c.closeAfterWrite = true;
+            c.in.clear();
+        }
+        heldBack = c.pending() > MAX_PENDING_OUT && !c.in.empty();
+
+        // Answer whatever arrived before the peer shut its side, then close
+        if (c.peerClosed && !heldBack) c.closeAfterWrite = true;
+        if (!flush(w, fd, c)) return;
+    } while (heldBack && c.pending() <= MAX_PENDING_OUT);
+}
+
+bool HttpServer::flush(Worker& w, int fd, Connection& c) {
+    while (c.outPos < c.out.size()) {
+        ssize_t n = ::send(fd, c.out.data() + c.outPos, c.out.size() - c.outPos, MSG_NOSIGNAL);
+        if (n > 0) {
+            c.outPos += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) break;   // resume when the socket drains
+        closeConn(w, fd);
+        return false;
+    }
+
+    if (c.outPos == c.out.size()) {
+        c.out.clear();
+        c.outPos = 0;
+        if (c.closeAfterWrite) {
+            closeConn(w, fd);
+            return false;
+        }
+    }
+    watch(w, fd, c);
+    return true;
+}
+
+// Reads while the client keeps up with its responses and writes while
+// any are unsent. A connection that is closing is only written to.
+void HttpServer::watch(Worker& w, int fd, Connection& c) {
+    uint32_t events = 0;
+    if (!c.closeAfterWrite && !c.peerClosed && c.pending() <= MAX_PENDING_OUT) events |= EPOLLIN;
+    if (c.pending() > 0) events |= EPOLLOUT;
+    if (events == c.events) return;
+
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.fd = fd;
+    ::epoll_ctl(w.epollFd, EPOLL_CTL_MOD, fd, &ev);
+    c.events = events;
+}
+
+void HttpServer::closeConn(Worker& w, int fd) {
+    ::epoll_ctl(w.epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    w.conns.erase(fd);
+}
@@ -0,0 +1,129 @@
+#ifndef HTTPSERVER_H
+#define HTTPSERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Hotel;
+
+/*
+ * Embedded HTTP/1.1 JSON API over the live Hotel state.
+ *
+ * Each worker thread runs its own epoll loop on its own SO_REUSEPORT
+ * listening socket, so the kernel spreads connections across workers
+ * and no state is shared between loops. Connections are non-blocking
+ * and keep-alive (pipelined requests are answered in order).
+ *
+ *   GET  /                          dashboard.html
+ *   GET  /api/dashboard             dashboard JSON (also /dashboard_data.json)
+ *   GET  /metrics                   Prometheus text (builds with HOTEL_METRICS)
+ *   GET  /api/rooms/available       typeId, from, to (YYYY-MM-DD)
+ *   GET  /api/customers             phone, email and/or name (prefix), limit
+ *   GET  /api/occupancy             typeId (0 = all), from, to, step
+ *                                   (day / week / month); defaults to all
+ *                                   types over the last 365 days by month
+ *   GET  /api/quote                 roomId or typeId, nights, checkIn
+ *                                   (default today): room charge under
+ *                                   the rate plan
+ *   GET  /api/bookings/{id}
+ *   POST /api/customers             name, phone, email
+ *   POST /api/bookings              custId and roomId or typeId, with days
+ *                                   or checkIn (YYYY-MM-DD) and nights
+ *   POST /api/bookings/{id}/cancel
+ *   POST /api/bookings/{id}/checkout   extra
+ *   GET  /api/maintenance           open jobs, most urgent first
+ *   POST /api/maintenance           roomId, issue, date (default today),
+ *                                   priority (urgent / high / normal / low)
+ *   POST /api/maintenance/dispatch  starts jobs whose day has come
+ *   POST /api/maintenance/{id}/complete
+ *
+ * Parameters come from the query string or a form-encoded body; a
+ * malformed number or amount is refused with 400. Headers over 64 KiB
+ * are refused with 431 and bodies over 1 MiB with 413, and the
+ * connection is closed. A client that pipelines requests without
+ * reading the responses stops being read once 1 MiB of them is unsent.
+ *
+ * Requests run on their worker's loop thread, and a change returns only
+ * once it is durable: a journal append and fdatasync, or a full
+ * generation save when the journal is off or a checkpoint is due. Other
+ * connections on that worker wait meanwhile, so servers taking writes
+ * should run several workers and group commit (--group-commit), which
+ * also keeps checkpoints rare.
+ */
+class HttpServer {
+public:
+    struct Request {
+        std::string method;
+        std::string path;
+        std::map<std::string, std::string> params;
+        bool keepAlive = true;
+
+        const std::string* param(const std::string& name) const;
+    };
+
+    struct Response {
+        int status = 200;
+        std::string contentType = "application/json";
+        std::string body;
+    };
+
+    struct Connection {
+        std::string in;
+        std::string out;
+        size_t outPos = 0;
+        bool closeAfterWrite = false;
+        bool peerClosed = false;
+        uint32_t events = 0;   // as registered with epoll
+
+        size_t pending() const { return out.size() - outPos; }
+    };
+
+    HttpServer(Hotel& h, int port, int threads = 0);
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    bool start();
+    void stop();
+    int getPort() const { return port; }
+
+    // Routes one request. This and process() are public so they can be
+    // exercised without sockets.
+    Response handle(const Request& req);
+    // Parses and answers the complete requests in c.in, stopping while
+    // over 1 MiB of responses is unsent; returns 0, or the status to
+    // refuse the connection with: 400 for a malformed request, 431 / 413
+    // for headers or a body over the limits
+    int process(Connection& c);
+
+private:
+    struct Worker {
+        int listenFd = -1;
+        int epollFd = -1;
+        int wakeFd = -1;
+        std::unordered_map<int, Connection> conns;
+        std::thread thread;
+    };
+
+    Hotel& hotel;
+    int port;
+    int threadCount;
+    std::atomic<bool> running{false};
+    std::vector<Worker> workers;
+
+    void loop(Worker& w);
+    void acceptAll(Worker& w);
+    void onReadable(Worker& w, int fd);
+    void serve(Worker& w, int fd, Connection& c);
+    bool flush(Worker& w, int fd, Connection& c);
+    void watch(Worker& w, int fd, Connection& c);
+    void closeConn(Worker& w, int fd);
+};
+
+#endif
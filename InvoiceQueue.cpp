@@ -0,0 +1,148 @@
+#include "InvoiceQueue.h"
+#include "Metrics.h"
+#include "Date.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <sstream>
+
+/* ================= Rendering ================= */
+
+std::string renderInvoice(const Booking& b, const Payment& p) {
+    std::ostringstream f;
+    f << "Hotel Blue Whale - Invoice\n";
+    f << "Booking ID: " << b.bookingId << "\n";
+    f << "Customer ID: " << b.custId << "\n";
+    f << "Room ID: " << b.roomId << "\n";
+    f << "Days: " << b.days << "\n";
+    f << "Base: " << p.baseAmount << "\n";
+    f << "Extra: " << p.extraCharges << "\n";
+    f << "GST: " << p.calculateTax() << "\n";
+    f << "Total: " << p.total() << "\n";
+    return f.str();
+}
+
+std::string invoiceFileName(int bookingId) {
+    return "invoice_booking_" + std::to_string(bookingId) + ".txt";
+}
+
+bool writeInvoice(const std::string& path, const Booking& b, const Payment& p) {
+    HOTEL_TIMED(WriteInvoice);
+    std::string text = renderInvoice(b, p);
+    std::ofstream f(path, std::ios::binary);
+    if (!f.write(text.data(), (std::streamsize)text.size())) return false;
+    HOTEL_BYTES(WriteInvoice, text.size());
+    return true;
+}
+
+/* ================= Batch ================= */
+
+size_t writeInvoiceBatch(std::vector<InvoiceJob> jobs, const std::string& dir) {
+    HOTEL_TIMED(RenderInvoices);
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        std::cerr << "Cannot create " << dir << ": " << ec.message() << "\n";
+        return 0;
+    }
+
+    std::sort(jobs.begin(), jobs.end(), [](const InvoiceJob& a, const InvoiceJob& b) {
+        return a.booking.bookingId < b.booking.bookingId;
+    });
+
+    // Contiguous slices, one per hardware thread
+    std::vector<char> written(jobs.size(), 0);
+    size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    size_t slice = (jobs.size() + workers - 1) / workers;
+
+    auto writeSlice = [&](size_t from, size_t to) {
+        for (size_t i = from; i < to; i++) {
+            const InvoiceJob& j = jobs[i];
+            written[i] = writeInvoice(dir + "/" + invoiceFileName(j.booking.bookingId), j.booking, j.payment);
+        }
+    };
+
+    std::vector<std::future<void>> pending;
+    for (size_t from = slice; from < jobs.size(); from += slice)
+        pending.push_back(std::async(std::launch::async, writeSlice, from, std::min(jobs.size(), from + slice)));
+    writeSlice(0, std::min(jobs.size(), slice));
+    for (auto& f : pending) f.get();
+
+    // Index, replaced atomically
+    std::string index = dir + "/index.csv";
+    std::ofstream f(index + ".tmp", std::ios::binary);
+    f << "bookingId,custId,roomId,paymentId,paidOn,total,file\n";
+    size_t count = 0;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        if (!written[i]) continue;
+        const InvoiceJob& j = jobs[i];
+        f << j.booking.bookingId << "," << j.booking.custId << "," << j.booking.roomId << ","
+          << j.payment.paymentId << "," << (j.payment.paidOn ? formatDate(j.payment.paidOn) : "")
+          << "," << j.payment.total() << "," << invoiceFileName(j.booking.bookingId) << "\n";
+        count++;
+    }
+    f.close();
+    if (!f || std::rename((index + ".tmp").c_str(), index.c_str()) != 0) {
+        std::cerr << "Could not write " << index << "\n";
+        return 0;
+    }
+    return count;
+}
+
+/* ================= Queue ================= */
+
+InvoiceQueue::InvoiceQueue(size_t cap, std::string d)
+    : capacity(cap > 0 ? cap : 1), dir(std::move(d)) {}
+
+InvoiceQueue::~InvoiceQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    notEmpty.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+void InvoiceQueue::push(const InvoiceJob& job) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!worker.joinable()) worker = std::thread(&InvoiceQueue::run, this);
+
+    notFull.wait(lock, [&] { return jobs.size() < capacity; });
+    jobs.push_back(job);
+    notEmpty.notify_one();
+}
+
+void InvoiceQueue::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [&] { return jobs.empty() && !writing; });
+}
+
+size_t InvoiceQueue::backlog() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs.size();
+}
+
+void InvoiceQueue::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        notEmpty.wait(lock, [&] { return !jobs.empty() || stopping; });
+        if (jobs.empty()) return;   // stopping, and everything is written
+
+        InvoiceJob job = jobs.front();
+        jobs.pop_front();
+        writing = true;
+        notFull.notify_one();
+        lock.unlock();
+
+        if (!writeInvoice(dir + "/" + invoiceFileName(job.booking.bookingId), job.booking, job.payment))
+            std::cerr << "Could not write invoice for booking " << job.booking.bookingId << "\n";
+
+        lock.lock();
+        writing = false;
+        if (jobs.empty()) idle.notify_all();
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef INVOICEQUEUE_H
+#define INVOICEQUEUE_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Booking.h"
+#include "Payment.h"
+
+// Invoice text for a checked-out booking
+std::string renderInvoice(const Booking& b, const Payment& p);
+// "invoice_booking_<id>.txt"
+std::string invoiceFileName(int bookingId);
+bool writeInvoice(const std::string& path, const Booking& b, const Payment& p);
+
+struct InvoiceJob {
+    Booking booking;
+    Payment payment;
+};
+
+// Batch mode: writes every invoice into dir (created if missing) on
+// several threads, plus an index.csv listing them in booking order.
+// Returns the number of invoices written.
+size_t writeInvoiceBatch(std::vector<InvoiceJob> jobs, const std::string& dir);
+
+/*
+ * Background invoice writer, so that checkout does not wait on invoice
+ * file I/O. Invoices go to invoice_booking_<id>.txt in dir, in the order
+ * queued, from one worker thread started on first use.
+ *
+ * The backlog is bounded: push() blocks while capacity invoices are
+ * waiting, which slows checkouts down instead of letting memory grow
+ * without limit. The destructor writes out whatever is still queued.
+ */
+class InvoiceQueue {
+public:
+    explicit InvoiceQueue(size_t capacity = 1024, std::string dir = ".");
+    ~InvoiceQueue();
+
+    InvoiceQueue(const InvoiceQueue&) = delete;
+    InvoiceQueue& operator=(const InvoiceQueue&) = delete;
+
+    void push(const InvoiceJob& job);
+    // Waits until every invoice queued so far is written
+    void flush();
+    size_t backlog() const;
+
+private:
+    const size_t capacity;
+    const std::string dir;
+
+    mutable std::mutex mutex;
+    std::condition_variable notEmpty, notFull, idle;
+    std::deque<InvoiceJob> jobs;
+    bool writing = false;
+    bool stopping = false;
+    std::thread worker;
+
+    void run();
+};
+
+#endif
@@ -0,0 +1,249 @@
+#include "Journal.h"
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+
+/* ================= Encoding ================= */
+
+static uint32_t fnv1a(const std::string& s) {
+    uint32_t h = 2166136261u;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void escapeInto(std::string& out, const std::string& s) {
+    for (char c : s) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '\t') out += "\\t";
+        else if (c == '\n') out += "\\n";
+        else out += c;
+    }
+}
+
+static std::vector<std::string> splitFields(const std::string& line) {
+    std::vector<std::string> fields(1);
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (c == '\t') {
+            fields.emplace_back();
+        } else if (c == '\\' && i + 1 < line.size()) {
+            char n = line[++i];
+            fields.back() += (n == 't') ? '\t' : (n == 'n') ? '\n' : n;
+        } else {
+            fields.back() += c;
+        }
+    }
+    return fields;
+}
+
+JournalEntry& JournalEntry::add(double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.17g", v);
+    fields.push_back(buf);
+    return *this;
+}
+
+std::string JournalEntry::encode() const {
+    std::string body;
+    for (size_t i = 0; i < fields.size(); i++) {
+        if (i) body += '\t';
+        escapeInto(body, fields[i]);
+    }
+
+    char sum[16];
+    std::snprintf(sum, sizeof(sum), "%08x", fnv1a(body));
+    return body + '\t' + sum + '\n';
+}
+
+bool JournalEntry::decode(const std::string& line, std::vector<std::string>& fields) {
+    size_t tab = line.rfind('\t');
+    if (tab == std::string::npos) return false;
+
+    char sum[16];
+    std::snprintf(sum, sizeof(sum), "%08x", fnv1a(line.substr(0, tab)));
+    if (line.compare(tab + 1, std::string::npos, sum) != 0) return false;
+
+    fields = splitFields(line.substr(0, tab));
+    return true;
+}
+
+/* ================= Journal File ================= */
+
+Journal::~Journal() {
+    close();
+}
+
+bool Journal::openLocked() {
+    if (fd >= 0) return true;
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    // fdatasync covers the records, not the file's entry in its directory
+    std::string dir = std::filesystem::path(path).parent_path().string();
+    int d = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_CLOEXEC);
+    if (d >= 0) {
+        if (syncWrites) ::fsync(d);
+        ::close(d);
+    }
+    return true;
+}
+
+bool Journal::open() {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    return openLocked();
+}
+
+void Journal::close() {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void Journal::setGroupCommit(std::chrono::microseconds batchWindow, size_t batchRecords) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    grouped = true;
+    window = batchWindow;
+    maxBatch = std::max<size_t>(1, batchRecords);
+}
+
+// One write() of whole lines, then the sync. On failure the file is cut
+// back to where it was, so no torn line hides the records after it; if
+// that fails too the journal refuses appends until rotate().
+bool Journal::writeOut(const std::string& data) {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (broken || !openLocked()) return false;
+
+    off_t start = ::lseek(fd, 0, SEEK_END);
+    if (start < 0) return false;
+
+    const char* p = data.data();
+    size_t left = data.size();
+    bool ok = true;
+
+    while (left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ok = false;
+            break;
+        }
+        p += n;
+        left -= (size_t)n;
+    }
+
+    if (ok && (!syncWrites || ::fdatasync(fd) == 0)) return true;
+
+    if (::ftruncate(fd, start) != 0 || (syncWrites && ::fdatasync(fd) != 0)) broken = true;
+    return false;
+}
+
+bool Journal::append(const JournalEntry& e) {
+    HOTEL_TIMED(JournalAppend);
+    std::string line = e.encode();
+    HOTEL_BYTES(JournalAppend, line.size());
+
+    if (grouped) return appendGrouped(std::move(line));
+
+    if (!writeOut(line)) return false;
+    records++;
+    return true;
+}
+
+bool Journal::appendGrouped(std::string line) {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    if (!openBatch) {
+        openBatch = std::make_shared<Batch>();
+        openBatch->opened = std::chrono::steady_clock::now();
+    }
+    std::shared_ptr<Batch> mine = openBatch;
+    mine->data += line;
+    if (++mine->records >= maxBatch) queueCv.notify_all();
+
+    while (!mine->done) {
+        if (flushing) {
+            queueCv.wait(lock);
+            continue;
+        }
+
+        // Nobody is writing, so our batch is still the open one: lead it
+        flushing = true;
+        queueCv.wait_until(lock, mine->opened + window,
+                           [&] { return mine->records >= maxBatch; });
+        std::shared_ptr<Batch> batch = std::move(openBatch);
+        lock.unlock();
+
+        // Every caller in the batch gets this write's own result: a failed
+        // write or sync was cut off the file, so none of them is durable
+        bool ok;
+        {
+            HOTEL_TIMED(JournalFlush);
+            HOTEL_BYTES(JournalFlush, batch->data.size());
+            ok = writeOut(batch->data);
+        }
+
+        lock.lock();
+        if (ok) records += batch->records;
+        batch->ok = ok;
+        batch->done = true;
+        flushing = false;
+        queueCv.notify_all();
+    }
+    return mine->ok;
+}
+
+bool Journal::hasRecords(const std::string& path) {
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0 && st.st_size > 0;
+}
+
+size_t Journal::replay(const std::string& path,
+                       const std::function<void(const std::vector<std::string>&)>& apply) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return 0;
+
+    size_t applied = 0;
+    std::string line;
+    std::vector<std::string> fields;
+
+    while (std::getline(f, line)) {
+        // A last line without '\n' was cut short by a crash
+        if (f.eof()) break;
+        if (!JournalEntry::decode(line, fields)) break;
+
+        apply(fields);
+        applied++;
+    }
+
+    return applied;
+}
+
+std::string Journal::getPath() const {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    return path;
+}
+
+bool Journal::rotate(const std::string& next) {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    bool wasOpen = fd >= 0;
+    if (wasOpen) {
+        ::close(fd);
+        fd = -1;
+    }
+    path = next;
+    records = 0;
+    broken = false;
+    return !wasOpen || openLocked();
+}
@@ -0,0 +1,107 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+// One journal line: a flat list of fields describing the records
+// a single mutation touched (see Hotel::applyJournalEntry).
+class JournalEntry {
+public:
+    std::vector<std::string> fields;
+
+    JournalEntry& add(std::string_view s) { fields.emplace_back(s); return *this; }
+    JournalEntry& add(int v) { fields.push_back(std::to_string(v)); return *this; }
+    JournalEntry& add(double v);
+
+    bool empty() const { return fields.empty(); }
+
+    // Tab separated, escaped, terminated by a checksum field and '\n'
+    std::string encode() const;
+    // The fields of an encoded line (without its '\n'); false if the
+    // checksum does not match
+    static bool decode(const std::string& line, std::vector<std::string>& fields);
+};
+
+// Append-only write-ahead log. Every append is a single write()
+// followed by fdatasync(), so a record is either fully on disk or
+// detected as torn on replay. append() returns false unless the record
+// is durable; a failed write is cut off the file again.
+//
+// With group commit on, append() is safe to call from several threads:
+// concurrent records are gathered into one batch, written with one
+// write() and one fdatasync(), and each caller returns once its batch
+// is durable, or false for every caller of a batch that failed. The
+// first caller of a batch leads it: it waits up to the window for
+// others to join (or until maxBatch records are queued), then flushes
+// while later callers start the next batch.
+class Journal {
+private:
+    std::string path;
+    int fd = -1;
+    bool syncWrites = true;
+    std::atomic<size_t> records{0};
+    mutable std::mutex fileMutex;   // write/sync against rotate and close
+    bool broken = false;            // a failed write could not be cut back
+
+    struct Batch {
+        std::string data;
+        size_t records = 0;
+        std::chrono::steady_clock::time_point opened;
+        bool done = false;
+        bool ok = false;
+    };
+
+    bool grouped = false;
+    std::chrono::microseconds window{0};
+    size_t maxBatch = 1;
+    std::mutex queueMutex;
+    std::condition_variable queueCv;
+    std::shared_ptr<Batch> openBatch;   // accepting records
+    bool flushing = false;              // a leader owns the batch being written
+
+    bool openLocked();
+    bool writeOut(const std::string& data);
+    bool appendGrouped(std::string line);
+
+public:
+    explicit Journal(const std::string& p = "journal.log") : path(p) {}
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    bool open();
+    void close();
+    bool isOpen() const { return fd >= 0; }
+
+    bool append(const JournalEntry& e);
+
+    // Calls apply() for every intact entry of the file at path; stops
+    // at the first torn or corrupt line. Returns the number of entries
+    // applied.
+    static size_t replay(const std::string& path,
+                         const std::function<void(const std::vector<std::string>&)>& apply);
+
+    // Later appends go to next; the current file is left as it is
+    bool rotate(const std::string& next);
+
+    void setSync(bool s) { syncWrites = s; }
+    // Set before appending from several threads
+    void setGroupCommit(std::chrono::microseconds batchWindow, size_t batchRecords);
+    bool isGrouped() const { return grouped; }
+    size_t pendingRecords() const { return records; }
+    // True when the file at path holds anything to replay
+    static bool hasRecords(const std::string& path);
+    // A copy: rotate() may change it meanwhile
+    std::string getPath() const;
+};
+
+#endif
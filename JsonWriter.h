@@ -0,0 +1,140 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Streaming JSON writer into a reusable buffer. Commas, indentation
+// and string escaping are handled here; after clear() the buffer keeps
+// its capacity, so a long-lived writer stops allocating once warm.
+class JsonWriter {
+private:
+    std::string buf;
+    std::vector<bool> hasItems;   // per open container
+    bool pretty;
+    bool afterKey = false;
+
+    void newline() {
+        buf += '\n';
+        buf.append(hasItems.size() * 2, ' ');
+    }
+
+    // Separator before a new value or key inside the current container
+    void item() {
+        if (afterKey) {
+            afterKey = false;
+            return;
+        }
+        if (hasItems.empty()) return;
+        if (hasItems.back()) buf += ',';
+        hasItems.back() = true;
+        if (pretty) newline();
+    }
+
+    JsonWriter& open(char c) {
+        item();
+        buf += c;
+        hasItems.push_back(false);
+        return *this;
+    }
+
+    JsonWriter& close(char c) {
+        bool any = hasItems.back();
+        hasItems.pop_back();
+        if (pretty && any) newline();
+        buf += c;
+        return *this;
+    }
+
+    void quoted(std::string_view s) {
+        buf += '"';
+        for (char ch : s) {
+            unsigned char c = (unsigned char)ch;
+            switch (c) {
+                case '"':  buf += "\\\""; break;
+                case '\\': buf += "\\\\"; break;
+                case '\n': buf += "\\n"; break;
+                case '\r': buf += "\\r"; break;
+                case '\t': buf += "\\t"; break;
+                case '\b': buf += "\\b"; break;
+                case '\f': buf += "\\f"; break;
+                default:
+                    if (c < 0x20) {
+                        char esc[8];
+                        std::snprintf(esc, sizeof(esc), "\\u%04x", c);
+                        buf += esc;
+                    } else {
+                        buf += ch;
+                    }
+            }
+        }
+        buf += '"';
+    }
+
+    template <class T>
+    JsonWriter& number(T v) {
+        item();
+        char tmp[32];
+        auto res = std::to_chars(tmp, tmp + sizeof(tmp), v);
+        buf.append(tmp, res.ptr);
+        return *this;
+    }
+
+public:
+    explicit JsonWriter(bool indent = false) : pretty(indent) {}
+
+    void clear() {
+        buf.clear();
+        hasItems.clear();
+        afterKey = false;
+    }
+
+    JsonWriter& beginObject() { return open('{'); }
+    JsonWriter& endObject() { return close('}'); }
+    JsonWriter& beginArray() { return open('['); }
+    JsonWriter& endArray() { return close(']'); }
+
+    JsonWriter& key(std::string_view k) {
+        item();
+        quoted(k);
+        buf += pretty ? ": " : ":";
+        afterKey = true;
+        return *this;
+    }
+
+    JsonWriter& value(std::string_view s) { item(); quoted(s); return *this; }
+    JsonWriter& value(const char* s) { return value(std::string_view(s)); }
+    JsonWriter& value(const std::string& s) { return value(std::string_view(s)); }
+    JsonWriter& value(bool b) { item(); buf += b ? "true" : "false"; return *this; }
+    JsonWriter& value(int v) { return number(v); }
+    JsonWriter& value(long v) { return number(v); }
+    JsonWriter& value(long long v) { return number(v); }
+    JsonWriter& value(unsigned long v) { return number(v); }
+    // JSON has no NaN or infinity (an empty period's ADR, say)
+    JsonWriter& value(double v) {
+        if (std::isfinite(v)) return number(v);
+        item();
+        buf += "null";
+        return *this;
+    }
+
+    template <class T>
+    JsonWriter& field(std::string_view k, const T& v) {
+        key(k);
+        return value(v);
+    }
+
+    const std::string& str() const { return buf; }
+    std::string take() {
+        std::string out;
+        out.swap(buf);
+        clear();
+        return out;
+    }
+};
+
+#endif
@@ -2,23 +2,66 @@
 #define MAINTENANCE_H
 
 #include <string>
+#include <string_view>
+
+#include "Date.h"
 
 enum class MaintStatus { Scheduled, InProgress, Completed };
 
+// Most urgent first
+enum class MaintPriority { Urgent, High, Normal, Low };
+
+// For values read back from files, before casting
+inline bool isMaintStatus(int v) { return v >= 0 && v <= (int)MaintStatus::Completed; }
+inline bool isMaintPriority(int v) { return v >= 0 && v <= (int)MaintPriority::Low; }
+
+static const char* const MAINT_PRIORITY[] = { "urgent", "high", "normal", "low" };
+
+// Days from the scheduled day to the SLA deadline
+inline int slaDays(MaintPriority p) {
+    static const int days[] = { 0, 1, 3, 7 };
+    return days[(int)p];
+}
+
+// A name from MAINT_PRIORITY or its number
+inline bool parsePriority(const std::string& s, MaintPriority& p) {
+    for (int i = 0; i < 4; i++) {
+        if (s == MAINT_PRIORITY[i] || s == std::to_string(i)) {
+            p = (MaintPriority)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// issue and scheduledDate are interned in the owning Hotel's StringPool
 class Maintenance {
 public:
     int maintId;
     int roomId;
-    std::string issue;
+    std::string_view issue;
     MaintStatus status;
-    std::string scheduledDate;
+    std::string_view scheduledDate;
+    int day = 0;          // scheduledDate as a day number (see Date.h)
+    MaintPriority priority = MaintPriority::Normal;
+    int dueDay = 0;       // day + slaDays(priority)
+    int staffId = 0;      // technician, once the job has started
+    int completedOn = 0;
 
     Maintenance() = default;
 
-    Maintenance(int id, int r, const std::string &iss, const std::string &date)
+    Maintenance(int id, int r, std::string_view iss, std::string_view date)
         : maintId(id), roomId(r), issue(iss),
           status(MaintStatus::Scheduled), scheduledDate(date) {}
+
+    // Records saved before priorities have no due day: they become
+    // Normal jobs on their scheduledDate (day 0 if it does not parse)
+    void upgrade() {
+        if (dueDay != 0) return;
+        if (!parseDate(std::string(scheduledDate), day)) day = 0;
+        priority = MaintPriority::Normal;
+        dueDay = day + slaDays(priority);
+    }
 };
 
 #endif
-
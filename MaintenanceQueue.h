@@ -0,0 +1,104 @@
+#ifndef MAINTENANCEQUEUE_H
+#define MAINTENANCEQUEUE_H
+
+#include <deque>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Open maintenance jobs and idle technicians, for the dispatcher.
+ *
+ * Jobs wait in a calendar heap keyed by their scheduled day; once the
+ * day comes they move to a ready heap ordered by priority, SLA due day
+ * and ID. Technicians are handed out longest idle first. Every step is
+ * O(log n) in the open jobs, so dispatching can run after each change
+ * across thousands of rooms.
+ *
+ * held counts the jobs keeping each room out of service; the room goes
+ * back into use when the last of them completes.
+ *
+ * Not thread-safe; Hotel guards it with tableMutex like its other
+ * derived structures.
+ */
+class MaintenanceQueue {
+public:
+    struct Job {
+        int maintId;
+        int roomId;
+        int priority;   // MaintPriority, most urgent first
+        int day;
+        int dueDay;
+        bool holding;   // already keeps the room out of service
+    };
+
+    void clear() {
+        calendar = Heap<ByDay>();
+        ready = Heap<ByUrgency>();
+        idle.clear();
+        held.clear();
+    }
+
+    void push(const Job& j) { calendar.push(j); }
+
+    // The most urgent job scheduled on or before today
+    bool popReady(int today, Job& out) {
+        while (!calendar.empty() && calendar.top().day <= today) {
+            ready.push(calendar.top());
+            calendar.pop();
+        }
+        if (ready.empty()) return false;
+        out = ready.top();
+        ready.pop();
+        return true;
+    }
+
+    size_t open() const { return calendar.size() + ready.size(); }
+
+    void addTechnician(int staffId) { idle.push_back(staffId); }
+    // A technician taken but not used keeps their place in line
+    void returnTechnician(int staffId) { idle.push_front(staffId); }
+    size_t idleTechnicians() const { return idle.size(); }
+    bool takeTechnician(int& staffId) {
+        if (idle.empty()) return false;
+        staffId = idle.front();
+        idle.pop_front();
+        return true;
+    }
+
+    void hold(int roomId) { held[roomId]++; }
+    bool holding(int roomId) const { return held.count(roomId) != 0; }
+    // Jobs still holding the room
+    int release(int roomId) {
+        auto it = held.find(roomId);
+        if (it == held.end()) return 0;
+        if (--it->second > 0) return it->second;
+        held.erase(it);
+        return 0;
+    }
+
+private:
+    // std::priority_queue pops the largest, so the comparators say
+    // which job comes later
+    struct ByDay {
+        bool operator()(const Job& a, const Job& b) const {
+            return a.day != b.day ? a.day > b.day : a.maintId > b.maintId;
+        }
+    };
+    struct ByUrgency {
+        bool operator()(const Job& a, const Job& b) const {
+            if (a.priority != b.priority) return a.priority > b.priority;
+            if (a.dueDay != b.dueDay) return a.dueDay > b.dueDay;
+            return a.maintId > b.maintId;
+        }
+    };
+    template <class Later>
+    using Heap = std::priority_queue<Job, std::vector<Job>, Later>;
+
+    Heap<ByDay> calendar;
+    Heap<ByUrgency> ready;
+    std::deque<int> idle;
+    std::unordered_map<int, int> held;   // roomId -> jobs
+};
+
+#endif
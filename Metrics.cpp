@@ -0,0 +1,295 @@
+#include "Metrics.h"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace metrics {
+
+static const char* const OP_NAMES[] = {
+    "addCustomer",
+    "findCustomers",
+    "createBooking",
+    "createReservation",
+    "bookAnyRoom",
+    "findAvailableRooms",
+    "occupancySeries",
+    "quote",
+    "cancelBooking",
+    "checkoutBooking",
+    "getBooking",
+    "scheduleMaintenance",
+    "toggleRoomMaintenance",
+    "dispatchMaintenance",
+    "completeMaintenance",
+    "exportToJSON",
+    "saveAll",
+    "loadAll",
+    "checkpoint",
+    "importBatch",
+    "exportTables",
+    "chainAvailability",
+    "chainOccupancy",
+    "chainRevenue",
+    "commit",
+    "saveRooms",
+    "saveCustomers",
+    "saveBookings",
+    "savePayments",
+    "saveMaintenance",
+    "saveSnapshot",
+    "loadSnapshot",
+    "sealGeneration",
+    "recover",
+    "journalAppend",
+    "journalFlush",
+    "journalReplay",
+    "writeInvoice",
+    "writeInvoiceBatch",
+};
+
+static_assert(sizeof(OP_NAMES) / sizeof(OP_NAMES[0]) == (size_t)Op::Count,
+              "every metrics::Op needs a name");
+
+namespace {
+
+struct Table {
+    std::string property;   // empty for the process-wide table
+    OpStats ops[(size_t)Op::Count];
+
+    bool used() const {
+        for (const OpStats& s : ops)
+            if (s.latency.count() || s.bytes.load(std::memory_order_relaxed)) return true;
+        return false;
+    }
+};
+
+Table processTable;
+std::mutex tablesMutex;
+std::vector<std::unique_ptr<Table>> propertyTables;   // never removed
+thread_local Table* bound = &processTable;
+
+// The process-wide table first, then the properties in binding order
+std::vector<Table*> allTables() {
+    std::lock_guard<std::mutex> lock(tablesMutex);
+    std::vector<Table*> out{ &processTable };
+    for (const auto& t : propertyTables) out.push_back(t.get());
+    return out;
+}
+
+std::vector<Table*> oneTable(const std::string& property) {
+    if (property.empty()) return { &processTable };
+    std::lock_guard<std::mutex> lock(tablesMutex);
+    for (const auto& t : propertyTables)
+        if (t->property == property) return { t.get() };
+    return {};
+}
+
+} // namespace
+
+const char* opName(Op op) {
+    return OP_NAMES[(size_t)op];
+}
+
+OpStats& stats(Op op) {
+    return bound->ops[(size_t)op];
+}
+
+void bindProperty(const std::string& property) {
+    if (property.empty()) {
+        bound = &processTable;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(tablesMutex);
+    for (const auto& t : propertyTables) {
+        if (t->property == property) {
+            bound = t.get();
+            return;
+        }
+    }
+    propertyTables.emplace_back(new Table());
+    propertyTables.back()->property = property;
+    bound = propertyTables.back().get();
+}
+
+const std::string& boundProperty() {
+    return bound->property;
+}
+
+bool enabled() {
+#ifdef HOTEL_METRICS
+    return true;
+#else
+    return false;
+#endif
+}
+
+/* ================= Histogram ================= */
+
+uint64_t Histogram::quantile(double q) const {
+    uint64_t n = count();
+    if (n == 0) return 0;
+
+    uint64_t rank = (uint64_t)(q * (double)(n - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += counts[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            uint64_t lo = bucketLow(i);
+            uint64_t hi = (i + 1 < BUCKETS) ? bucketLow(i + 1) : lo;
+            uint64_t mid = lo + (hi - lo) / 2;
+            return mid < maxNanos() ? mid : maxNanos();
+        }
+    }
+    return maxNanos();
+}
+
+void Histogram::reset() {
+    for (auto& c : counts) c.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    peak.store(0, std::memory_order_relaxed);
+}
+
+void reset() {
+    for (Table* t : allTables()) {
+        for (auto& s : t->ops) {
+            s.latency.reset();
+            s.bytes.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+/* ================= Output ================= */
+
+void writeText(std::ostream& out) {
+    if (!enabled()) {
+        out << "Metrics are compiled out (build with HOTEL_METRICS).\n";
+        return;
+    }
+
+    char line[160];
+    for (const Table* t : allTables()) {
+        if (!t->property.empty()) {
+            if (!t->used()) continue;
+            out << "\n[" << t->property << "]\n";
+        }
+        std::snprintf(line, sizeof(line), "%-22s %10s %10s %10s %10s %10s %12s\n",
+                      "operation", "calls", "p50 us", "p90 us", "p99 us", "max us", "bytes");
+        out << line;
+
+        for (size_t i = 0; i < (size_t)Op::Count; i++) {
+            const OpStats& s = t->ops[i];
+            uint64_t calls = s.latency.count();
+            uint64_t bytes = s.bytes.load(std::memory_order_relaxed);
+            if (calls == 0 && bytes == 0) continue;
+
+            std::snprintf(line, sizeof(line), "%-22s %10llu %10.1f %10.1f %10.1f %10.1f %12llu\n",
+                          OP_NAMES[i], (unsigned long long)calls,
+                          s.latency.quantile(0.50) / 1e3, s.latency.quantile(0.90) / 1e3,
+                          s.latency.quantile(0.99) / 1e3, s.latency.maxNanos() / 1e3,
+                          (unsigned long long)bytes);
+            out << line;
+        }
+    }
+}
+
+// The label set of one operation in one table
+static std::string labels(const Table& t, size_t op) {
+    std::string out;
+    if (!t.property.empty()) {
+        out += "property=\"";
+        for (char c : t.property) {
+            if (c == '\\' || c == '"') out += '\\';
+            if (c == '\n') out += "\\n";
+            else out += c;
+        }
+        out += "\",";
+    }
+    out += "op=\"";
+    out += OP_NAMES[op];
+    out += '"';
+    return out;
+}
+
+static std::string prometheusText(const std::vector<Table*>& tables) {
+    std::string out;
+    if (!enabled()) return out;
+
+    char line[512];
+    auto emit = [&](const char* fmt, auto... args) {
+        std::snprintf(line, sizeof(line), fmt, args...);
+        out += line;
+    };
+
+    out += "# HELP hotel_op_latency_seconds Latency of Hotel operations.\n"
+           "# TYPE hotel_op_latency_seconds summary\n";
+    for (const Table* t : tables) {
+        for (size_t i = 0; i < (size_t)Op::Count; i++) {
+            const Histogram& h = t->ops[i].latency;
+            if (h.count() == 0) continue;
+
+            std::string l = labels(*t, i);
+            for (double q : { 0.5, 0.9, 0.99, 0.999 })
+                emit("hotel_op_latency_seconds{%s,quantile=\"%g\"} %.9f\n", l.c_str(), q,
+                     h.quantile(q) / 1e9);
+            emit("hotel_op_latency_seconds_sum{%s} %.9f\n", l.c_str(), h.sumNanos() / 1e9);
+            emit("hotel_op_latency_seconds_count{%s} %llu\n", l.c_str(),
+                 (unsigned long long)h.count());
+        }
+    }
+
+    out += "# HELP hotel_op_max_seconds Slowest call of each Hotel operation.\n"
+           "# TYPE hotel_op_max_seconds gauge\n";
+    for (const Table* t : tables) {
+        for (size_t i = 0; i < (size_t)Op::Count; i++) {
+            const Histogram& h = t->ops[i].latency;
+            if (h.count() == 0) continue;
+            emit("hotel_op_max_seconds{%s} %.9f\n", labels(*t, i).c_str(), h.maxNanos() / 1e9);
+        }
+    }
+
+    out += "# HELP hotel_persist_bytes_total Bytes written by persistence calls.\n"
+           "# TYPE hotel_persist_bytes_total counter\n";
+    for (const Table* t : tables) {
+        for (size_t i = 0; i < (size_t)Op::Count; i++) {
+            uint64_t bytes = t->ops[i].bytes.load(std::memory_order_relaxed);
+            if (bytes == 0) continue;
+            emit("hotel_persist_bytes_total{%s} %llu\n", labels(*t, i).c_str(),
+                 (unsigned long long)bytes);
+        }
+    }
+    return out;
+}
+
+std::string prometheusText() {
+    return prometheusText(allTables());
+}
+
+std::string prometheusText(const std::string& property) {
+    return prometheusText(oneTable(property));
+}
+
+// Written through a temporary file so a scraper never sees half of it
+static bool writeFile(const std::string& path, const std::string& text) {
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        if (!f) return false;
+        f.write(text.data(), (std::streamsize)text.size());
+        if (!f.flush()) return false;
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+bool writePrometheusFile(const std::string& path) {
+    return writeFile(path, prometheusText());
+}
+
+bool writePrometheusFile(const std::string& path, const std::string& property) {
+    return writeFile(path, prometheusText(property));
+}
+
+} // namespace metrics
@@ -0,0 +1,188 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/*
+ * Hot-path instrumentation: call counts, latency histograms and bytes
+ * written, per operation. Operations are a fixed enum indexing a static
+ * table, so recording is two clock reads and a few relaxed atomic adds.
+ *
+ * Build with HOTEL_METRICS defined to enable it; otherwise the
+ * HOTEL_TIMED / HOTEL_BYTES macros expand to nothing.
+ *
+ * With several properties in one process (PropertyRegistry.h) each
+ * property has its own table: a thread bound to a property records
+ * there, any other thread in the process-wide table. Output labels the
+ * property tables with property="name".
+ */
+namespace metrics {
+
+enum class Op {
+    // Public Hotel API
+    AddCustomer,
+    FindCustomers,
+    CreateBooking,
+    CreateReservation,
+    BookAnyRoom,
+    FindAvailableRooms,
+    OccupancyQuery,
+    Quote,
+    CancelBooking,
+    CheckoutBooking,
+    GetBooking,
+    ScheduleMaintenance,
+    ToggleMaintenance,
+    DispatchMaintenance,
+    CompleteMaintenance,
+    ExportJSON,
+    SaveAll,
+    LoadAll,
+    Checkpoint,
+    BulkImport,
+    BulkExport,
+
+    // Chain-wide scatter-gather queries, see PropertyRegistry.h
+    ChainAvailability,
+    ChainOccupancy,
+    ChainRevenue,
+
+    // Persistence internals
+    Commit,          // journal append or full save after a change
+    SaveRooms,
+    SaveCustomers,
+    SaveBookings,
+    SavePayments,
+    SaveMaintenance,
+    SaveSnapshot,
+    LoadSnapshot,
+    SealGeneration,  // checksums, fsyncs and MANIFEST rename of a save
+    Recover,         // picking the newest consistent generation at load
+    JournalAppend,
+    JournalFlush,    // one group-commit batch: write + fdatasync
+    JournalReplay,
+    WriteInvoice,
+    RenderInvoices,  // one batch of invoices
+
+    Count
+};
+
+const char* opName(Op op);
+
+// Log-linear histogram of nanosecond values, HDR style: values below 16
+// get their own bucket, above that every power of two is split into 16
+// sub-buckets (about 6% relative error) up to 2^48 ns.
+class Histogram {
+public:
+    static constexpr int SUB_BITS = 4;
+    static constexpr int SUB = 1 << SUB_BITS;
+    static constexpr int MAX_BIT = 47;
+    static constexpr int BUCKETS = (MAX_BIT - SUB_BITS + 2) * SUB;
+
+    static int bucketOf(uint64_t v) {
+        if (v < (uint64_t)SUB) return (int)v;
+        int msb = 63 - __builtin_clzll(v);
+        if (msb > MAX_BIT) return BUCKETS - 1;
+        int sub = (int)((v >> (msb - SUB_BITS)) & (SUB - 1));
+        return (msb - SUB_BITS + 1) * SUB + sub;
+    }
+
+    // Smallest value falling into bucket i
+    static uint64_t bucketLow(int i) {
+        if (i < SUB) return (uint64_t)i;
+        int msb = i / SUB + SUB_BITS - 1;
+        return (uint64_t)(SUB + i % SUB) << (msb - SUB_BITS);
+    }
+
+    void record(uint64_t ns) {
+        counts[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(ns, std::memory_order_relaxed);
+
+        uint64_t m = peak.load(std::memory_order_relaxed);
+        while (ns > m && !peak.compare_exchange_weak(m, ns, std::memory_order_relaxed)) {}
+    }
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t sumNanos() const { return sum.load(std::memory_order_relaxed); }
+    uint64_t maxNanos() const { return peak.load(std::memory_order_relaxed); }
+
+    // Approximate value at quantile q (0..1), as the middle of its bucket
+    uint64_t quantile(double q) const;
+
+    void reset();
+
+private:
+    std::atomic<uint64_t> counts[BUCKETS] = {};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> peak{0};
+};
+
+struct OpStats {
+    Histogram latency;
+    std::atomic<uint64_t> bytes{0};    // bytes written, persistence calls only
+};
+
+// The calling thread's table
+OpStats& stats(Op op);
+
+// Operations on this thread count toward the property from now on; ""
+// goes back to the process-wide table
+void bindProperty(const std::string& property);
+const std::string& boundProperty();
+
+inline void addBytes(Op op, uint64_t n) {
+    stats(op).bytes.fetch_add(n, std::memory_order_relaxed);
+}
+
+// Records the lifetime of the enclosing scope into op's histogram
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Op o) : op(o), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        stats(op).latency.record((uint64_t)ns);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Op op;
+    std::chrono::steady_clock::time_point start;
+};
+
+bool enabled();
+void reset();
+
+// Human-readable table of every operation that was called, one per
+// property that recorded anything
+void writeText(std::ostream& out);
+
+// Prometheus text exposition format (version 0.0.4), of every table or
+// of one property's ("" for the process-wide one)
+std::string prometheusText();
+std::string prometheusText(const std::string& property);
+bool writePrometheusFile(const std::string& path);
+bool writePrometheusFile(const std::string& path, const std::string& property);
+
+} // namespace metrics
+
+#ifdef HOTEL_METRICS
+#define HOTEL_METRICS_CAT2(a, b) a##b
+#define HOTEL_METRICS_CAT(a, b) HOTEL_METRICS_CAT2(a, b)
+#define HOTEL_TIMED(op) \
+    ::metrics::ScopedTimer HOTEL_METRICS_CAT(metricsTimer_, __LINE__)(::metrics::Op::op)
+#define HOTEL_BYTES(op, n) ::metrics::addBytes(::metrics::Op::op, (uint64_t)(n))
+#else
+#define HOTEL_TIMED(op) ((void)0)
+#define HOTEL_BYTES(op, n) ((void)0)
+#endif
+
+#endif
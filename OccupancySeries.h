@@ -0,0 +1,247 @@
+#ifndef OCCUPANCYSERIES_H
+#define OCCUPANCYSERIES_H
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Date.h"
+
+/*
+ * Daily occupancy and revenue per room type, with week and month
+ * rollups, so trend queries (occupancy, ADR, RevPAR) never rescan the
+ * bookings or payments.
+ *
+ * Per type and day it keeps:
+ *   roomNights     rooms sold for that night (Confirmed and CheckedOut
+ *                  stays, by night of stay)
+ *   roomRevenue    base room charge of checked-out stays, spread evenly
+ *                  over their nights; ADR and RevPAR are based on it
+ *   revenue        payment totals with extras and tax, by day paid
+ *   arrivals       stays starting that day (not cancelled)
+ *   departures     checkouts that day
+ *   cancellations  cancelled stays, by their planned arrival day
+ *
+ * Supply is the type's current room count for every day. Updates cost
+ * O(nights); a range query adds whole months and weeks from the rollups
+ * and only the days at its edges.
+ */
+
+enum class Resolution { Day, Week, Month };
+
+struct OccupancyPoint {
+    int start = 0;       // first day (Date.h day number)
+    int days = 0;
+    double roomNights = 0.0;
+    double supply = 0.0;          // rooms * days
+    double roomRevenue = 0.0;
+    double revenue = 0.0;
+    int arrivals = 0, departures = 0, cancellations = 0;
+
+    // Percent of supply sold
+    double occupancy() const { return supply > 0 ? 100.0 * roomNights / supply : 0.0; }
+    // Average daily rate: room revenue per night sold
+    double adr() const { return roomNights > 0 ? roomRevenue / roomNights : 0.0; }
+    // Room revenue per available room night
+    double revpar() const { return supply > 0 ? roomRevenue / supply : 0.0; }
+};
+
+class OccupancySeries {
+public:
+    void clear() { types.clear(); }
+
+    void setRooms(int typeId, int rooms) { types[typeId].rooms = rooms; }
+
+    void addStay(int typeId, int checkIn, int nights) {
+        Series& s = types[typeId];
+        add(s, checkIn, Cell{ 0, 1, 0, 0, 0.0, 0.0 });
+        for (int n = 0; n < nights; n++) add(s, checkIn + n, Cell{ 1, 0, 0, 0, 0.0, 0.0 });
+    }
+
+    void removeStay(int typeId, int checkIn, int nights) {
+        Series& s = types[typeId];
+        add(s, checkIn, Cell{ 0, -1, 0, 0, 0.0, 0.0 });
+        for (int n = 0; n < nights; n++) add(s, checkIn + n, Cell{ -1, 0, 0, 0, 0.0, 0.0 });
+    }
+
+    void addCancellation(int typeId, int checkIn) {
+        add(types[typeId], checkIn, Cell{ 0, 0, 0, 1, 0.0, 0.0 });
+    }
+
+    // A paid stay: base spread over its nights, total on the day paid
+    void addCheckout(int typeId, int checkIn, int nights, double base, double total, int paidOn) {
+        Series& s = types[typeId];
+        if (nights > 0) {
+            double perNight = base / nights;
+            for (int n = 0; n < nights; n++) add(s, checkIn + n, Cell{ 0, 0, 0, 0, perNight, 0.0 });
+        }
+        if (paidOn) add(s, paidOn, Cell{ 0, 0, 1, 0, 0.0, total });
+    }
+
+    int rooms(int typeId) const {
+        auto it = types.find(typeId);
+        return (it != types.end()) ? it->second.rooms : 0;
+    }
+
+    // Rooms of the type sold for one night
+    int roomNightsOn(int typeId, int day) const {
+        auto it = types.find(typeId);
+        if (it == types.end()) return 0;
+        const Cell* c = it->second.days.get(day);
+        return c ? c->roomNights : 0;
+    }
+
+    // Rebuilding from the tables: days only, then the rollups in one pass
+    void beginRebuild() { rollups = false; }
+    void endRebuild() {
+        rollups = true;
+        for (auto& t : types) {
+            Series& s = t.second;
+            s.weeks = Buckets();
+            s.months = Buckets();
+            for (size_t i = 0; i < s.days.cells.size(); i++) {
+                const Cell& c = s.days.cells[i];
+                if (c.empty()) continue;
+                int day = s.days.first + (int)i;
+                s.weeks.at(weekOf(day)) += c;
+                s.months.at(monthOf(day)) += c;
+            }
+        }
+    }
+
+    // typeId 0 sums every type
+    OccupancyPoint total(int typeId, int from, int to) const {
+        OccupancyPoint p;
+        p.start = from;
+        p.days = std::max(0, to - from);
+        for (const auto& t : types) {
+            if (typeId != 0 && t.first != typeId) continue;
+            const Series& s = t.second;
+            p.supply += (double)s.rooms * p.days;
+
+            int d = from;
+            while (d < to) {
+                int y, m, dd;
+                civilFromDays(d, y, m, dd);
+                int monthEnd = (m == 12) ? daysFromCivil(y + 1, 1, 1) : daysFromCivil(y, m + 1, 1);
+                int w = weekOf(d);
+                if (dd == 1 && monthEnd <= to) {
+                    addTo(p, s.months.get(monthOf(d)));
+                    d = monthEnd;
+                } else if (weekStart(w) == d && d + 7 <= to) {
+                    addTo(p, s.weeks.get(w));
+                    d += 7;
+                } else {
+                    addTo(p, s.days.get(d));
+                    d++;
+                }
+            }
+        }
+        return p;
+    }
+
+    // One point per day, week (from Monday) or calendar month overlapping
+    // [from, to); the first and last are clipped to the range
+    std::vector<OccupancyPoint> series(int typeId, int from, int to, Resolution step) const {
+        std::vector<OccupancyPoint> out;
+        int d = from;
+        while (d < to) {
+            int next = d + 1;
+            if (step == Resolution::Week) {
+                next = weekStart(weekOf(d)) + 7;
+            } else if (step == Resolution::Month) {
+                int y, m, dd;
+                civilFromDays(d, y, m, dd);
+                next = (m == 12) ? daysFromCivil(y + 1, 1, 1) : daysFromCivil(y, m + 1, 1);
+            }
+            next = std::min(next, to);
+            out.push_back(total(typeId, d, next));
+            d = next;
+        }
+        return out;
+    }
+
+private:
+    struct Cell {
+        int32_t roomNights, arrivals, departures, cancellations;
+        double roomRevenue, revenue;
+
+        Cell& operator+=(const Cell& o) {
+            roomNights += o.roomNights;
+            arrivals += o.arrivals;
+            departures += o.departures;
+            cancellations += o.cancellations;
+            roomRevenue += o.roomRevenue;
+            revenue += o.revenue;
+            return *this;
+        }
+        bool empty() const {
+            return !roomNights && !arrivals && !departures && !cancellations &&
+                   roomRevenue == 0.0 && revenue == 0.0;
+        }
+    };
+
+    // Cells indexed by day, week or month number from first; grows at
+    // either end by half its size so loading in any order stays linear
+    struct Buckets {
+        int first = 0;
+        std::vector<Cell> cells;
+
+        Cell& at(int i) {
+            if (cells.empty()) {
+                first = i;
+                cells.resize(1, Cell{});
+            } else if (i < first) {
+                int grow = std::max(first - i, (int)cells.size() / 2 + 1);
+                cells.insert(cells.begin(), (size_t)grow, Cell{});
+                first -= grow;
+            } else if (i - first >= (int)cells.size()) {
+                int need = i - first + 1;
+                cells.resize((size_t)std::max(need, (int)cells.size() * 3 / 2 + 1), Cell{});
+            }
+            return cells[(size_t)(i - first)];
+        }
+
+        const Cell* get(int i) const {
+            if (i < first || i - first >= (int)cells.size()) return nullptr;
+            return &cells[(size_t)(i - first)];
+        }
+    };
+
+    struct Series {
+        int rooms = 0;
+        Buckets days, weeks, months;
+    };
+
+    std::unordered_map<int, Series> types;
+    bool rollups = true;
+
+    // Weeks start on Monday; day 0 (1970-01-01) was a Thursday
+    static int weekOf(int day) { return (day + 3 >= 0) ? (day + 3) / 7 : -((-(day + 3) + 6) / 7); }
+    static int weekStart(int week) { return week * 7 - 3; }
+    static int monthOf(int day) {
+        int y, m, d;
+        civilFromDays(day, y, m, d);
+        return y * 12 + m - 1;
+    }
+
+    void add(Series& s, int day, const Cell& delta) {
+        s.days.at(day) += delta;
+        if (!rollups) return;
+        s.weeks.at(weekOf(day)) += delta;
+        s.months.at(monthOf(day)) += delta;
+    }
+
+    static void addTo(OccupancyPoint& p, const Cell* c) {
+        if (!c) return;
+        p.roomNights += c->roomNights;
+        p.roomRevenue += c->roomRevenue;
+        p.revenue += c->revenue;
+        p.arrivals += c->arrivals;
+        p.departures += c->departures;
+        p.cancellations += c->cancellations;
+    }
+};
+
+#endif
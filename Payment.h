@@ -12,12 +12,13 @@ public:
     double baseAmount;
     double extraCharges;
     double taxRate;
+    int paidOn;          // day number (Date.h), 0 = unknown
 
     Payment() = default;
 
-    Payment(int pid, int bid, double base, double extra, double tax)
+    Payment(int pid, int bid, double base, double extra, double tax, int paid = 0)
         : paymentId(pid), bookingId(bid),
-          baseAmount(base), extraCharges(extra), taxRate(tax) {}
+          baseAmount(base), extraCharges(extra), taxRate(tax), paidOn(paid) {}
 
     double calculateTax() const {
         return (baseAmount + extraCharges) * taxRate;
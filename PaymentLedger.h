@@ -0,0 +1,180 @@
+#ifndef PAYMENTLEDGER_H
+#define PAYMENTLEDGER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Payment.h"
+#include "Date.h"
+
+/*
+ * Column store for payments. Each field lives in its own contiguous
+ * array, so the revenue kernels below stream only the columns they need
+ * and compile to tight (vectorisable) loops instead of calling
+ * Payment::total() per record.
+ *
+ * roomTypeId is denormalised from the booking so that group-by-type
+ * needs no booking lookups; Hotel keeps it in sync (see rebuildStats).
+ */
+class PaymentLedger {
+public:
+    std::vector<int32_t> paymentId;
+    std::vector<int32_t> bookingId;
+    std::vector<int32_t> roomTypeId;
+    std::vector<int32_t> paidOn;       // day number, 0 = unknown
+    std::vector<double> baseAmount;
+    std::vector<double> extraCharges;
+    std::vector<double> taxRate;
+
+    size_t size() const { return paymentId.size(); }
+    bool empty() const { return paymentId.empty(); }
+
+    void clear() {
+        paymentId.clear();
+        bookingId.clear();
+        roomTypeId.clear();
+        paidOn.clear();
+        baseAmount.clear();
+        extraCharges.clear();
+        taxRate.clear();
+    }
+
+    void reserve(size_t n) {
+        paymentId.reserve(n);
+        bookingId.reserve(n);
+        roomTypeId.reserve(n);
+        paidOn.reserve(n);
+        baseAmount.reserve(n);
+        extraCharges.reserve(n);
+        taxRate.reserve(n);
+    }
+
+    void push_back(const Payment& p, int typeId = 0) {
+        paymentId.push_back(p.paymentId);
+        bookingId.push_back(p.bookingId);
+        roomTypeId.push_back(typeId);
+        paidOn.push_back(p.paidOn);
+        baseAmount.push_back(p.baseAmount);
+        extraCharges.push_back(p.extraCharges);
+        taxRate.push_back(p.taxRate);
+    }
+
+    // Overwrites row i, keeping its room type
+    void set(size_t i, const Payment& p) {
+        paymentId[i] = p.paymentId;
+        bookingId[i] = p.bookingId;
+        paidOn[i] = p.paidOn;
+        baseAmount[i] = p.baseAmount;
+        extraCharges[i] = p.extraCharges;
+        taxRate[i] = p.taxRate;
+    }
+
+    Payment operator[](size_t i) const {
+        return Payment(paymentId[i], bookingId[i], baseAmount[i], extraCharges[i], taxRate[i], paidOn[i]);
+    }
+
+    Payment back() const { return (*this)[size() - 1]; }
+
+    // Same arithmetic as Payment::total(), so both agree to the last bit
+    double total(size_t i) const {
+        double net = baseAmount[i] + extraCharges[i];
+        return net + net * taxRate[i];
+    }
+
+    /* ---------- Kernels ---------- */
+
+    // The by-date kernels take an optional row count: rows are only ever
+    // appended, so the first n rows are the ledger as a pinned view saw it
+
+    // Sum of all totals. Four independent accumulators break the add
+    // dependency chain and let the compiler use packed arithmetic.
+    double sumTotal() const {
+        const size_t n = size();
+        const double* b = baseAmount.data();
+        const double* e = extraCharges.data();
+        const double* t = taxRate.data();
+
+        double acc[4] = { 0, 0, 0, 0 };
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            for (size_t k = 0; k < 4; k++) {
+                double net = b[i + k] + e[i + k];
+                acc[k] += net + net * t[i + k];
+            }
+        }
+        for (; i < n; i++) {
+            double net = b[i] + e[i];
+            acc[0] += net + net * t[i];
+        }
+        return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    }
+
+    // Revenue per room type id
+    std::unordered_map<int, double> sumByRoomType() const {
+        const size_t n = size();
+        std::vector<double> dense;                // small ids, indexed directly
+        std::unordered_map<int, double> out;      // everything else, then the result
+
+        for (size_t i = 0; i < n; i++) {
+            int type = roomTypeId[i];
+            if (type >= 0 && type < 1024) {
+                if ((size_t)type >= dense.size()) dense.resize((size_t)type + 1, 0.0);
+                dense[(size_t)type] += total(i);
+            } else {
+                out[type] += total(i);
+            }
+        }
+
+        for (size_t type = 0; type < dense.size(); type++)
+            if (dense[type] != 0.0) out[(int)type] += dense[type];
+        return out;
+    }
+
+    // Revenue per day over [from, to); payments outside the range or
+    // without a date are skipped
+    std::vector<double> sumByDay(int from, int to, size_t rows = SIZE_MAX) const {
+        std::vector<double> out(to > from ? (size_t)(to - from) : 0, 0.0);
+        const size_t n = std::min(rows, size());
+        const size_t days = out.size();
+
+        for (size_t i = 0; i < n; i++) {
+            size_t d = (size_t)(uint32_t)(paidOn[i] - from);
+            if (d < days) out[d] += total(i);
+        }
+        return out;
+    }
+
+    // Revenue per calendar month over [from, to), as (YYYYMM, revenue)
+    std::vector<std::pair<int, double>> sumByMonth(int from, int to, size_t rows = SIZE_MAX) const {
+        std::vector<double> daily = sumByDay(from, to, rows);
+        std::vector<std::pair<int, double>> out;
+
+        for (size_t d = 0; d < daily.size(); d++) {
+            int y, m, day;
+            civilFromDays(from + (int)d, y, m, day);
+            int key = y * 100 + m;
+            if (out.empty() || out.back().first != key) out.emplace_back(key, 0.0);
+            out.back().second += daily[d];
+        }
+        return out;
+    }
+
+    // Earliest and latest payment date; false when no payment has one
+    bool dateRange(int& first, int& last, size_t rows = SIZE_MAX) const {
+        bool any = false;
+        const size_t n = std::min(rows, size());
+        for (size_t i = 0; i < n; i++) {
+            int d = paidOn[i];
+            if (d == 0) continue;
+            if (!any || d < first) first = d;
+            if (!any || d > last) last = d;
+            any = true;
+        }
+        return any;
+    }
+};
+
+#endif
@@ -0,0 +1,186 @@
+#include "PropertyRegistry.h"
+#include "Metrics.h"
+
+#include <map>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/* ================= Shards ================= */
+
+PropertyRegistry::Shard::Shard(std::string n, std::string dir, int c)
+    : name(std::move(n)), dataDir(std::move(dir)), cpu(c),
+      loaded(loadedPromise.get_future().share()),
+      thread(&Shard::loop, this) {}
+
+PropertyRegistry::Shard::~Shard() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    notEmpty.notify_all();
+    if (thread.joinable()) thread.join();
+}
+
+void PropertyRegistry::Shard::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    notEmpty.notify_one();
+}
+
+Hotel& PropertyRegistry::Shard::hotel() {
+    loaded.get();   // rethrows a failed load
+    return *property;
+}
+
+void PropertyRegistry::Shard::loop() {
+#ifdef __linux__
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#endif
+
+    // Everything this thread runs is the property's in the metrics
+    metrics::bindProperty(name);
+
+    // Loading here puts the tables on this CPU's memory node
+    try {
+        property.reset(new Hotel(dataDir));
+        loadedPromise.set_value();
+    } catch (...) {
+        // Queued work still runs, and fails through its future
+        loadedPromise.set_exception(std::current_exception());
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        notEmpty.wait(lock, [&] { return !tasks.empty() || stopping; });
+        if (tasks.empty()) break;   // stopping, and the queue is drained
+
+        std::function<void()> task = std::move(tasks.front());
+        tasks.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+    lock.unlock();
+
+    property.reset();
+}
+
+/* ================= Registry ================= */
+
+PropertyRegistry::~PropertyRegistry() {
+    std::unique_lock<std::shared_mutex> lock(shardsMutex);
+    shards.clear();
+}
+
+int PropertyRegistry::addProperty(const std::string& name, const std::string& dataDir) {
+    std::unique_lock<std::shared_mutex> lock(shardsMutex);
+    for (const auto& s : shards)
+        if (s->name == name) return -1;
+
+    unsigned cpus = std::thread::hardware_concurrency();
+    int cpu = cpus ? (int)(shards.size() % cpus) : -1;
+    shards.emplace_back(new Shard(name, dataDir, cpu));
+    return (int)shards.size() - 1;
+}
+
+size_t PropertyRegistry::size() const {
+    std::shared_lock<std::shared_mutex> lock(shardsMutex);
+    return shards.size();
+}
+
+int PropertyRegistry::find(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(shardsMutex);
+    for (size_t i = 0; i < shards.size(); i++)
+        if (shards[i]->name == name) return (int)i;
+    return -1;
+}
+
+std::string PropertyRegistry::name(size_t i) const {
+    return shard(i).name;
+}
+
+Hotel& PropertyRegistry::hotel(size_t i) {
+    return shard(i).hotel();
+}
+
+// Shards are never removed, so the reference outlives the lock
+PropertyRegistry::Shard& PropertyRegistry::shard(size_t i) const {
+    std::shared_lock<std::shared_mutex> lock(shardsMutex);
+    return *shards.at(i);
+}
+
+/* ================= Chain Queries ================= */
+
+ChainAvailability PropertyRegistry::chainAvailability(int typeId, int from, int to) {
+    HOTEL_TIMED(ChainAvailability);
+    auto rooms = scatter([=](Hotel& h) { return h.findAvailableRooms(typeId, from, to); });
+
+    ChainAvailability out;
+    out.properties.reserve(rooms.size());
+    for (size_t i = 0; i < rooms.size(); i++) {
+        out.totalRooms += rooms[i].size();
+        out.properties.push_back({ name(i), std::move(rooms[i]) });
+    }
+    return out;
+}
+
+ChainOccupancy PropertyRegistry::chainOccupancy() {
+    HOTEL_TIMED(ChainOccupancy);
+    auto counts = scatter([](Hotel& h) {
+        PropertyOccupancy o;
+        o.available = h.countAvailableRooms();
+        o.booked = h.countBookedRooms();
+        o.maintenance = h.countMaintenanceRooms();
+        return o;
+    });
+
+    ChainOccupancy out;
+    out.total.property = "Chain";
+    for (size_t i = 0; i < counts.size(); i++) {
+        counts[i].property = name(i);
+        out.total.available += counts[i].available;
+        out.total.booked += counts[i].booked;
+        out.total.maintenance += counts[i].maintenance;
+    }
+    out.properties = std::move(counts);
+    return out;
+}
+
+ChainRevenue PropertyRegistry::chainRevenue(int from, int to) {
+    HOTEL_TIMED(ChainRevenue);
+    struct Part {
+        PropertyRevenue revenue;
+        std::vector<std::pair<int, double>> byMonth;
+    };
+    auto parts = scatter([=](Hotel& h) {
+        Part p;
+        p.revenue.completed = h.completedRevenue();
+        p.revenue.estimatedActive = h.estimatedRevenueActive();
+        p.byMonth = h.revenueByMonth(from, to);
+        return p;
+    });
+
+    ChainRevenue out;
+    out.total.property = "Chain";
+    std::map<int, double> months;
+    for (size_t i = 0; i < parts.size(); i++) {
+        Part& p = parts[i];
+        p.revenue.property = name(i);
+        out.total.completed += p.revenue.completed;
+        out.total.estimatedActive += p.revenue.estimatedActive;
+        for (const auto& m : p.byMonth) months[m.first] += m.second;
+        out.properties.push_back(std::move(p.revenue));
+    }
+    out.byMonth.assign(months.begin(), months.end());
+    return out;
+}
@@ -0,0 +1,162 @@
+#ifndef PROPERTYREGISTRY_H
+#define PROPERTYREGISTRY_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Hotel.h"
+
+/*
+ * Several properties of a chain in one process. Each property is a Hotel
+ * shard with its own data directory, owned by a shard thread pinned to
+ * one CPU (round robin). The Hotel is loaded, queried and destroyed on
+ * that thread, so its tables stay warm in that CPU's cache and are
+ * allocated on its memory node.
+ *
+ * run() queues work on a shard's thread. The chain* queries scatter one
+ * task to every property and merge the answers in property order.
+ * Hotel's own methods stay thread-safe, so hotel() may also be used
+ * directly, e.g. to serve one property over HTTP.
+ *
+ * Each shard thread records its metrics under the property's name
+ * (label property="name"); calls made directly through hotel() from
+ * other threads count toward the process-wide table. Dashboard and
+ * metrics exports go under the property's data directory.
+ */
+
+struct PropertyAvailability {
+    std::string property;
+    std::vector<int> rooms;   // free over the whole range
+};
+
+struct PropertyOccupancy {
+    std::string property;
+    int available = 0, booked = 0, maintenance = 0;
+
+    int rooms() const { return available + booked + maintenance; }
+    // Booked share of all rooms, in percent
+    double occupancy() const { return rooms() ? 100.0 * booked / rooms() : 0.0; }
+};
+
+struct PropertyRevenue {
+    std::string property;
+    double completed = 0.0;         // paid at checkout
+    double estimatedActive = 0.0;   // confirmed stays not yet paid
+};
+
+struct ChainAvailability {
+    std::vector<PropertyAvailability> properties;
+    size_t totalRooms = 0;
+};
+
+struct ChainOccupancy {
+    std::vector<PropertyOccupancy> properties;
+    PropertyOccupancy total;        // property is "Chain"
+};
+
+struct ChainRevenue {
+    std::vector<PropertyRevenue> properties;
+    PropertyRevenue total;          // property is "Chain"
+    // Chain revenue per calendar month as (YYYYMM, amount)
+    std::vector<std::pair<int, double>> byMonth;
+};
+
+class PropertyRegistry {
+public:
+    PropertyRegistry() = default;
+    // Finishes every shard's queued work and unloads its Hotel
+    ~PropertyRegistry();
+
+    PropertyRegistry(const PropertyRegistry&) = delete;
+    PropertyRegistry& operator=(const PropertyRegistry&) = delete;
+
+    // Starts a shard loading the property in dataDir and returns its
+    // index, or -1 if the name is already taken. Properties load in
+    // parallel; work queued meanwhile runs once the load is done.
+    int addProperty(const std::string& name, const std::string& dataDir);
+    size_t size() const;
+    int find(const std::string& name) const;
+    std::string name(size_t shard) const;
+    // Waits for the property to finish loading; rethrows a failed load
+    Hotel& hotel(size_t shard);
+
+    // Runs f(Hotel&) on the shard's thread
+    template <class F>
+    auto run(size_t shard, F f) -> std::future<std::invoke_result_t<F, Hotel&>>;
+
+    // Runs f(Hotel&) on every shard in parallel; results in shard order
+    template <class F>
+    auto scatter(F f) -> std::vector<std::invoke_result_t<F, Hotel&>>;
+
+    // Rooms of the type free over [from, to) at every property
+    ChainAvailability chainAvailability(int typeId, int from, int to);
+    ChainOccupancy chainOccupancy();
+    // Months cover [from, to) (day numbers, see Date.h)
+    ChainRevenue chainRevenue(int from, int to);
+
+private:
+    class Shard {
+    public:
+        Shard(std::string name, std::string dataDir, int cpu);
+        ~Shard();
+
+        const std::string name;
+        const std::string dataDir;
+
+        void post(std::function<void()> task);
+        Hotel& hotel();
+
+    private:
+        const int cpu;
+        std::unique_ptr<Hotel> property;
+        std::promise<void> loadedPromise;
+        std::shared_future<void> loaded;
+
+        std::mutex mutex;
+        std::condition_variable notEmpty;
+        std::deque<std::function<void()>> tasks;
+        bool stopping = false;
+        std::thread thread;   // declared last: starts once the rest exists
+
+        void loop();
+    };
+
+    mutable std::shared_mutex shardsMutex;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    Shard& shard(size_t i) const;
+};
+
+template <class F>
+auto PropertyRegistry::run(size_t i, F f) -> std::future<std::invoke_result_t<F, Hotel&>> {
+    Shard& s = shard(i);
+    // std::function needs a copyable target, packaged_task is move-only
+    auto task = std::make_shared<std::packaged_task<std::invoke_result_t<F, Hotel&>()>>(
+        [&s, f = std::move(f)]() mutable { return f(s.hotel()); });
+    auto result = task->get_future();
+    s.post([task] { (*task)(); });
+    return result;
+}
+
+template <class F>
+auto PropertyRegistry::scatter(F f) -> std::vector<std::invoke_result_t<F, Hotel&>> {
+    std::vector<std::future<std::invoke_result_t<F, Hotel&>>> pending;
+    for (size_t i = 0, n = size(); i < n; i++) pending.push_back(run(i, f));
+
+    std::vector<std::invoke_result_t<F, Hotel&>> results;
+    results.reserve(pending.size());
+    for (auto& p : pending) results.push_back(p.get());
+    return results;
+}
+
+#endif
@@ -0,0 +1,178 @@
+#include "RateEngine.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+/* ================= Rate plan ================= */
+
+static bool parseMonthDay(const std::string& s, int& month, int& day) {
+    char tail;
+    if (std::sscanf(s.c_str(), "%2d-%2d%c", &month, &day, &tail) != 2) return false;
+    return month >= 1 && month <= 12 && day >= 1 && day <= 31;
+}
+
+bool loadRatePlan(const std::string& path, RatePlan& plan) {
+    std::ifstream f(path);
+    if (!f) return false;
+    parseRatePlan(f, path, plan);
+    return true;
+}
+
+void parseRatePlan(std::istream& f, const std::string& source, RatePlan& plan) {
+    plan = RatePlan();
+    std::string line;
+    int lineNo = 0;
+
+    while (std::getline(f, line)) {
+        lineNo++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+
+        std::istringstream in(line);
+        std::string kind;
+        if (!(in >> kind)) continue;
+
+        bool ok = false;
+        if (kind == "season") {
+            std::string from, to;
+            RatePlan::Season s{ 0, 0, 0, 0, 1.0, 0 };
+            ok = (in >> from >> to >> s.multiplier) && s.multiplier > 0.0 &&
+                 parseMonthDay(from, s.fromMonth, s.fromDay) &&
+                 parseMonthDay(to, s.toMonth, s.toDay);
+            if (ok && !(in >> s.typeId)) s.typeId = 0;
+            if (ok) plan.seasons.push_back(s);
+        } else if (kind == "occupancy") {
+            RatePlan::OccupancyTier t{ 0.0, 1.0, 0 };
+            ok = (in >> t.percent >> t.multiplier) && t.percent >= 0.0 && t.multiplier > 0.0;
+            if (ok && !(in >> t.typeId)) t.typeId = 0;
+            if (ok) plan.occupancy.push_back(t);
+        } else if (kind == "stay") {
+            RatePlan::StayTier t{ 0, 1.0 };
+            ok = (in >> t.nights >> t.multiplier) && t.nights > 0 && t.multiplier > 0.0;
+            if (ok) plan.stays.push_back(t);
+        }
+
+        if (!ok) std::cerr << source << ":" << lineNo << ": bad rate rule skipped\n";
+    }
+}
+
+std::string formatRatePlan(const RatePlan& plan) {
+    std::ostringstream out;
+    out.precision(17);
+    char from[16], to[16];
+    for (const RatePlan::Season& s : plan.seasons) {
+        std::snprintf(from, sizeof(from), "%02d-%02d", s.fromMonth, s.fromDay);
+        std::snprintf(to, sizeof(to), "%02d-%02d", s.toMonth, s.toDay);
+        out << "season " << from << " " << to << " " << s.multiplier << " " << s.typeId << "\n";
+    }
+    for (const RatePlan::OccupancyTier& t : plan.occupancy)
+        out << "occupancy " << t.percent << " " << t.multiplier << " " << t.typeId << "\n";
+    for (const RatePlan::StayTier& t : plan.stays)
+        out << "stay " << t.nights << " " << t.multiplier << "\n";
+    return out.str();
+}
+
+/* ================= Rules ================= */
+
+double RateEngine::seasonFactor(int typeId, int day) const {
+    if (rules.seasons.empty()) return 1.0;
+
+    int y, m, d;
+    civilFromDays(day, y, m, d);
+    int key = m * 100 + d;
+
+    double factor = 1.0;
+    for (const RatePlan::Season& s : rules.seasons) {
+        if (s.typeId != 0 && s.typeId != typeId) continue;
+        int from = s.fromMonth * 100 + s.fromDay;
+        int to = s.toMonth * 100 + s.toDay;
+        bool in = (from <= to) ? (key >= from && key <= to) : (key >= from || key <= to);
+        if (in) factor = s.multiplier;
+    }
+    return factor;
+}
+
+double RateEngine::occupancyFactor(int typeId, int day, const OccupancySeries& occ) const {
+    if (rules.occupancy.empty()) return 1.0;
+    int rooms = occ.rooms(typeId);
+    if (rooms <= 0) return 1.0;
+
+    double percent = 100.0 * occ.roomNightsOn(typeId, day) / rooms;
+    double best = -1.0, factor = 1.0;
+    for (const RatePlan::OccupancyTier& t : rules.occupancy) {
+        if (t.typeId != 0 && t.typeId != typeId) continue;
+        if (percent >= t.percent && t.percent > best) {
+            best = t.percent;
+            factor = t.multiplier;
+        }
+    }
+    return factor;
+}
+
+double RateEngine::stayFactor(int nights) const {
+    int best = 0;
+    double factor = 1.0;
+    for (const RatePlan::StayTier& t : rules.stays) {
+        if (nights >= t.nights && t.nights > best) {
+            best = t.nights;
+            factor = t.multiplier;
+        }
+    }
+    return factor;
+}
+
+/* ================= Tables ================= */
+
+RateEngine::Table& RateEngine::tableFor(int typeId, const OccupancySeries& occ) {
+    auto it = tables.find(typeId);
+    if (it != tables.end()) return it->second;
+
+    Table& t = tables[typeId];
+    t.season.resize(HORIZON);
+    t.factor.resize(HORIZON);
+    for (int i = 0; i < HORIZON; i++) {
+        t.season[i] = seasonFactor(typeId, first + i);
+        t.factor[i] = t.season[i] * occupancyFactor(typeId, first + i, occ);
+    }
+    return t;
+}
+
+void RateEngine::rebuild(const std::vector<int>& typeIds, int firstDay, const OccupancySeries& occ) {
+    tables.clear();
+    first = firstDay;
+    for (int typeId : typeIds) tableFor(typeId, occ);
+}
+
+void RateEngine::roomsChanged(int typeId, const OccupancySeries& occ) {
+    Table& t = tableFor(typeId, occ);
+    if (!rules.occupancy.empty()) t.stale = true;
+}
+
+void RateEngine::refresh(int typeId, int from, int nights, const OccupancySeries& occ) {
+    Table& t = tableFor(typeId, occ);
+    if (t.stale) {
+        t.stale = false;
+        from = first;
+        nights = HORIZON;
+    }
+    int lo = std::max(from, first), hi = std::min(from + nights, first + HORIZON);
+    for (int d = lo; d < hi; d++)
+        t.factor[d - first] = t.season[d - first] * occupancyFactor(typeId, d, occ);
+}
+
+double RateEngine::quote(int typeId, double nightlyBase, int checkIn, int nights,
+                         const OccupancySeries& occ) const {
+    auto it = tables.find(typeId);
+    const Table* t = (it != tables.end() && !it->second.stale) ? &it->second : nullptr;
+
+    double factors = 0.0;
+    for (int n = 0; n < nights; n++) {
+        int d = checkIn + n;
+        if (t && d >= first && d < first + HORIZON) factors += t->factor[d - first];
+        else factors += seasonFactor(typeId, d) * occupancyFactor(typeId, d, occ);
+    }
+    return factors * nightlyBase * stayFactor(nights);
+}
@@ -0,0 +1,111 @@
+#ifndef RATEENGINE_H
+#define RATEENGINE_H
+
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "OccupancySeries.h"
+
+/*
+ * Rate plan: rules that turn a room's nightly base price (the type's
+ * basePrice, or Room::customPrice when set) into a price per night.
+ *
+ *   season FROM TO MULTIPLIER [typeId]     FROM / TO as MM-DD, inclusive,
+ *                                           may wrap the year end
+ *   occupancy PERCENT MULTIPLIER [typeId]  applies once the type's
+ *                                           occupancy that night reaches
+ *                                           PERCENT
+ *   stay NIGHTS MULTIPLIER                 whole stays of NIGHTS or more
+ *
+ * Read from rates.conf in the data directory; '#' starts a comment. When
+ * several seasons match a night the last one listed wins; the highest
+ * occupancy tier reached and the longest stay tier reached apply.
+ * Without a plan every night costs the base price.
+ */
+struct RatePlan {
+    struct Season {
+        int fromMonth, fromDay, toMonth, toDay;
+        double multiplier;
+        int typeId;      // 0 for every type
+    };
+    struct OccupancyTier {
+        double percent;
+        double multiplier;
+        int typeId;
+    };
+    struct StayTier {
+        int nights;
+        double multiplier;
+    };
+
+    std::vector<Season> seasons;
+    std::vector<OccupancyTier> occupancy;
+    std::vector<StayTier> stays;
+
+    bool empty() const { return seasons.empty() && occupancy.empty() && stays.empty(); }
+};
+
+// False if the file cannot be read; bad lines are reported and skipped
+bool loadRatePlan(const std::string& path, RatePlan& plan);
+// The same rules from any stream; source names it in the reports
+void parseRatePlan(std::istream& in, const std::string& source, RatePlan& plan);
+// The plan as rates.conf lines, which parseRatePlan reads back
+std::string formatRatePlan(const RatePlan& plan);
+
+/*
+ * Precomputed nightly factors per room type for HORIZON days from the
+ * day the tables were built: season multiplier times the occupancy tier
+ * of that night. Quotes then cost one lookup per night and no rule
+ * evaluation. Bookings and cancellations refresh the nights they touch
+ * (refresh()), so the occupancy tiers follow the occupancy series.
+ * Nights outside the tables fall back to evaluating the rules.
+ *
+ * Adding rooms changes every night's occupancy percentage, so with
+ * occupancy tiers the type's table is marked stale instead of being
+ * recomputed per room; quotes evaluate the rules until the next
+ * refresh() rebuilds it once.
+ *
+ * Not thread-safe; Hotel guards it with tableMutex like its other
+ * derived structures.
+ */
+class RateEngine {
+public:
+    static constexpr int HORIZON = 2 * 366;
+
+    void setPlan(RatePlan p) { rules = std::move(p); }
+    const RatePlan& plan() const { return rules; }
+
+    // Rebuilds every table starting at day first
+    void rebuild(const std::vector<int>& typeIds, int first, const OccupancySeries& occ);
+    // Occupancy of the type changed on [from, from + nights)
+    void refresh(int typeId, int from, int nights, const OccupancySeries& occ);
+    // The type's room count changed
+    void roomsChanged(int typeId, const OccupancySeries& occ);
+    int firstDay() const { return first; }
+
+    // Room charge for nights starting at checkIn, at nightlyBase per
+    // night before the rules
+    double quote(int typeId, double nightlyBase, int checkIn, int nights,
+                 const OccupancySeries& occ) const;
+
+private:
+    struct Table {
+        std::vector<double> season;   // season multiplier per night
+        std::vector<double> factor;   // season * occupancy tier
+        bool stale = false;           // room count changed since factor was built
+    };
+
+    RatePlan rules;
+    int first = 0;
+    std::unordered_map<int, Table> tables;
+
+    // Builds the whole table the first time a type is seen
+    Table& tableFor(int typeId, const OccupancySeries& occ);
+    double seasonFactor(int typeId, int day) const;
+    double occupancyFactor(int typeId, int day, const OccupancySeries& occ) const;
+    double stayFactor(int nights) const;
+};
+
+#endif
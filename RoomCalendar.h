@@ -0,0 +1,48 @@
+#ifndef ROOMCALENDAR_H
+#define ROOMCALENDAR_H
+
+#include <map>
+
+// Reserved stays of one room as non-overlapping half-open day ranges,
+// keyed by check-in day. Overlap checks and updates are O(log n).
+class RoomCalendar {
+public:
+    struct Stay {
+        int checkOut;
+        int bookingId;
+    };
+
+    bool isFree(int from, int to) const {
+        auto it = stays.lower_bound(to);
+        if (it == stays.begin()) return true;
+        --it;
+        return it->second.checkOut <= from;
+    }
+
+    bool reserve(int from, int to, int bookingId) {
+        if (from >= to || !isFree(from, to)) return false;
+        stays.emplace(from, Stay{ to, bookingId });
+        return true;
+    }
+
+    void release(int from, int bookingId) {
+        auto it = stays.find(from);
+        if (it != stays.end() && it->second.bookingId == bookingId) stays.erase(it);
+    }
+
+    // Booking whose stay covers the given day, or -1
+    int occupant(int day) const {
+        auto it = stays.upper_bound(day);
+        if (it == stays.begin()) return -1;
+        --it;
+        return (it->second.checkOut > day) ? it->second.bookingId : -1;
+    }
+
+    size_t size() const { return stays.size(); }
+    void clear() { stays.clear(); }
+
+private:
+    std::map<int, Stay> stays;
+};
+
+#endif
@@ -0,0 +1,293 @@
+#include "Snapshot.h"
+#include "Metrics.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace snap;
+
+/* ================= Writer ================= */
+
+namespace {
+
+class Heap {
+public:
+    std::string data;
+
+    StrRef add(std::string_view s) {
+        StrRef r{ data.size(), (uint32_t)s.size(), 0 };
+        data += s;
+        return r;
+    }
+};
+
+void align8(std::string& buf) {
+    while (buf.size() % 8) buf += '\0';
+}
+
+template <class Rec>
+void appendRecords(std::string& buf, const std::vector<Rec>& recs) {
+    if (!recs.empty())
+        buf.append(reinterpret_cast<const char*>(recs.data()), recs.size() * sizeof(Rec));
+}
+
+} // namespace
+
+bool writeSnapshot(const std::string& path,
+                   const std::vector<Room>& rooms,
+                   const std::vector<Customer>& customers,
+                   const std::vector<Booking>& bookings,
+                   const PaymentLedger& payments,
+                   const std::vector<Maintenance>& maintenance) {
+    Heap heap;
+
+    std::vector<RoomRec> roomRecs;
+    roomRecs.reserve(rooms.size());
+    for (const auto& r : rooms)
+        roomRecs.push_back({ r.roomId, r.typeId, (int32_t)r.status, 0, r.customPrice });
+
+    std::vector<CustomerRec> custRecs;
+    custRecs.reserve(customers.size());
+    for (const auto& c : customers)
+        custRecs.push_back({ c.custId, 0, heap.add(c.name), heap.add(c.phone), heap.add(c.email) });
+
+    std::vector<BookingRec> bookingRecs;
+    bookingRecs.reserve(bookings.size());
+    for (const auto& b : bookings)
+        bookingRecs.push_back({ b.bookingId, b.custId, b.roomId, b.roomTypeId, b.days,
+                                (int32_t)b.status, b.checkIn, 0, b.amount });
+
+    std::vector<PaymentRec> payRecs;
+    payRecs.reserve(payments.size());
+    for (size_t i = 0; i < payments.size(); i++)
+        payRecs.push_back({ payments.paymentId[i], payments.bookingId[i], payments.baseAmount[i],
+                            payments.extraCharges[i], payments.taxRate[i], payments.paidOn[i], 0 });
+
+    std::vector<MaintRec> maintRecs;
+    maintRecs.reserve(maintenance.size());
+    for (const auto& m : maintenance)
+        maintRecs.push_back({ m.maintId, m.roomId, (int32_t)m.status, 0,
+                              heap.add(m.issue), heap.add(m.scheduledDate), (int32_t)m.priority,
+                              m.day, m.dueDay, m.staffId, m.completedOn, 0 });
+
+    const uint32_t sectionCount = 6;
+    std::string buf(sizeof(SnapHeader) + sectionCount * sizeof(SnapSection), '\0');
+    std::vector<SnapSection> table;
+
+    auto begin = [&](uint32_t kind, uint32_t recSize, uint64_t count) {
+        align8(buf);
+        table.push_back({ kind, recSize, count, buf.size(), 0 });
+    };
+    auto end = [&]() { table.back().bytes = buf.size() - table.back().offset; };
+
+    begin(ROOMS, sizeof(RoomRec), roomRecs.size());             appendRecords(buf, roomRecs);    end();
+    begin(CUSTOMERS, sizeof(CustomerRec), custRecs.size());     appendRecords(buf, custRecs);    end();
+    begin(BOOKINGS, sizeof(BookingRec), bookingRecs.size());    appendRecords(buf, bookingRecs); end();
+    begin(PAYMENTS, sizeof(PaymentRec), payRecs.size());        appendRecords(buf, payRecs);     end();
+    begin(MAINTENANCE, sizeof(MaintRec), maintRecs.size());     appendRecords(buf, maintRecs);   end();
+    begin(STRINGS, 1, heap.data.size());                        buf += heap.data;                end();
+
+    SnapHeader h;
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.sectionCount = sectionCount;
+    std::memcpy(&buf[0], &h, sizeof(h));
+    std::memcpy(&buf[sizeof(h)], table.data(), table.size() * sizeof(SnapSection));
+
+    HOTEL_BYTES(SaveSnapshot, buf.size());
+
+    std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    const char* p = buf.data();
+    size_t left = buf.size();
+    while (left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n <= 0) {
+            ::close(fd);
+            ::unlink(tmp.c_str());
+            return false;
+        }
+        p += n;
+        left -= (size_t)n;
+    }
+
+    // Renaming an unsynced file could replace a good snapshot with one
+    // whose data never reached the disk
+    bool synced = ::fsync(fd) == 0;
+    if (::close(fd) != 0 || !synced) {
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+/* ================= Reader ================= */
+
+SnapshotReader::~SnapshotReader() {
+    close();
+}
+
+bool SnapshotReader::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    void* m = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) return false;
+
+    base = static_cast<const char*>(m);
+    length = (size_t)st.st_size;
+    ::madvise(m, length, MADV_SEQUENTIAL);
+
+    SnapHeader h;
+    std::memcpy(&h, base, sizeof(h));
+    if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.version > VERSION ||
+        sizeof(SnapHeader) + (size_t)h.sectionCount * sizeof(SnapSection) > length) {
+        close();
+        return false;
+    }
+
+    sections.resize(h.sectionCount);
+    std::memcpy(sections.data(), base + sizeof(SnapHeader), h.sectionCount * sizeof(SnapSection));
+
+    for (const auto& s : sections) {
+        if (s.offset > length || s.bytes > length - s.offset ||
+            (s.kind != STRINGS && s.recordSize && s.count * s.recordSize > s.bytes)) {
+            close();
+            return false;
+        }
+    }
+    strings = section(STRINGS);
+    return true;
+}
+
+void SnapshotReader::close() {
+    if (base) ::munmap(const_cast<char*>(base), length);
+    base = nullptr;
+    length = 0;
+    sections.clear();
+    strings = nullptr;
+}
+
+const SnapSection* SnapshotReader::section(uint32_t kind) const {
+    for (const auto& s : sections)
+        if (s.kind == kind) return &s;
+    return nullptr;
+}
+
+size_t SnapshotReader::count(uint32_t kind) const {
+    const SnapSection* s = section(kind);
+    return s ? (size_t)s->count : 0;
+}
+
+template <class Rec>
+bool SnapshotReader::record(const SnapSection* s, size_t i, Rec& out) const {
+    if (!s || i >= s->count) return false;
+
+    std::memset(&out, 0, sizeof(Rec));
+    size_t n = std::min<size_t>(s->recordSize, sizeof(Rec));
+    std::memcpy(&out, base + s->offset + i * s->recordSize, n);
+    return true;
+}
+
+std::string_view SnapshotReader::str(const StrRef& r) const {
+    const SnapSection* s = strings;
+    if (!s || r.off > s->bytes || r.len > s->bytes - r.off) return {};
+    return std::string_view(base + s->offset + r.off, r.len);
+}
+
+bool SnapshotReader::readRooms(std::vector<Room>& out) const {
+    const SnapSection* sec = section(ROOMS);
+    size_t n = sec ? (size_t)sec->count : 0;
+    out.clear();
+    out.reserve(n);
+
+    RoomRec rec;
+    for (size_t i = 0; i < n && record(sec, i, rec); i++) {
+        if (!isRoomStatus(rec.status)) break;   // counted as corrupt below
+        Room r(rec.roomId, rec.typeId, rec.customPrice);
+        r.status = (RoomStatus)rec.status;
+        out.push_back(r);
+    }
+    return out.size() == n;
+}
+
+bool SnapshotReader::readCustomers(std::vector<Customer>& out, StringPool& pool) const {
+    const SnapSection* sec = section(CUSTOMERS);
+    size_t n = sec ? (size_t)sec->count : 0;
+    out.clear();
+    out.reserve(n);
+
+    CustomerRec rec;
+    for (size_t i = 0; i < n && record(sec, i, rec); i++)
+        out.emplace_back(rec.custId, pool.store(str(rec.name)),
+                         pool.store(str(rec.phone)), pool.store(str(rec.email)));
+    return out.size() == n;
+}
+
+bool SnapshotReader::readBookings(std::vector<Booking>& out) const {
+    const SnapSection* sec = section(BOOKINGS);
+    size_t n = sec ? (size_t)sec->count : 0;
+    out.clear();
+    out.reserve(n);
+
+    BookingRec rec;
+    for (size_t i = 0; i < n && record(sec, i, rec); i++) {
+        if (!isBookingStatus(rec.status)) break;
+        Booking b(rec.bookingId, rec.custId, rec.roomId, rec.roomTypeId, rec.days, rec.checkIn);
+        b.status = (BookingStatus)rec.status;
+        b.amount = rec.amount;
+        out.push_back(b);
+    }
+    return out.size() == n;
+}
+
+bool SnapshotReader::readPayments(PaymentLedger& out) const {
+    const SnapSection* sec = section(PAYMENTS);
+    size_t n = sec ? (size_t)sec->count : 0;
+    out.clear();
+    out.reserve(n);
+
+    PaymentRec rec;
+    for (size_t i = 0; i < n && record(sec, i, rec); i++)
+        out.push_back(Payment(rec.paymentId, rec.bookingId, rec.baseAmount, rec.extraCharges,
+                              rec.taxRate, rec.paidOn));
+    return out.size() == n;
+}
+
+bool SnapshotReader::readMaintenance(std::vector<Maintenance>& out, StringPool& pool) const {
+    const SnapSection* sec = section(MAINTENANCE);
+    size_t n = sec ? (size_t)sec->count : 0;
+    out.clear();
+    out.reserve(n);
+
+    MaintRec rec;
+    for (size_t i = 0; i < n && record(sec, i, rec); i++) {
+        if (!isMaintStatus(rec.status) || !isMaintPriority(rec.priority)) break;
+        Maintenance m(rec.maintId, rec.roomId, pool.intern(str(rec.issue)),
+                      pool.intern(str(rec.scheduledDate)));
+        m.status = (MaintStatus)rec.status;
+        m.priority = (MaintPriority)rec.priority;
+        m.day = rec.day;
+        m.dueDay = rec.dueDay;
+        m.staffId = rec.staffId;
+        m.completedOn = rec.completedOn;
+        m.upgrade();   // zero in older snapshots
+        out.push_back(m);
+    }
+    return out.size() == n;
+}
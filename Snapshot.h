@@ -0,0 +1,156 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Room.h"
+#include "Customer.h"
+#include "Booking.h"
+#include "PaymentLedger.h"
+#include "StringPool.h"
+#include "Maintenance.h"
+
+/*
+ * hotel.snap layout (little endian):
+ *
+ *   SnapHeader
+ *   SnapSection[sectionCount]
+ *   section payloads, each 8-byte aligned
+ *
+ * Rooms, bookings and payments are arrays of fixed-width records.
+ * Customers and maintenance logs are fixed-width records whose text
+ * fields point into the STRINGS heap, so names and issues may contain
+ * spaces. Each section stores its record size; readers copy the
+ * prefix they know and zero the rest, so fields can be appended to a
+ * record without breaking older snapshots.
+ */
+
+namespace snap {
+
+const char MAGIC[8] = { 'H', 'T', 'L', 'S', 'N', 'A', 'P', '\0' };
+const uint32_t VERSION = 1;
+
+enum SectionKind : uint32_t { ROOMS = 1, CUSTOMERS, BOOKINGS, PAYMENTS, MAINTENANCE, STRINGS };
+
+struct SnapHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t sectionCount;
+};
+
+struct SnapSection {
+    uint32_t kind;
+    uint32_t recordSize;
+    uint64_t count;
+    uint64_t offset;
+    uint64_t bytes;
+};
+
+struct StrRef {
+    uint64_t off;
+    uint32_t len;
+    uint32_t pad;
+};
+
+struct RoomRec {
+    int32_t roomId;
+    int32_t typeId;
+    int32_t status;
+    int32_t pad;
+    double customPrice;
+};
+
+struct CustomerRec {
+    int32_t custId;
+    int32_t pad;
+    StrRef name;
+    StrRef phone;
+    StrRef email;
+};
+
+struct BookingRec {
+    int32_t bookingId;
+    int32_t custId;
+    int32_t roomId;
+    int32_t roomTypeId;
+    int32_t days;
+    int32_t status;
+    int32_t checkIn;
+    int32_t pad;
+    double amount;
+};
+
+struct PaymentRec {
+    int32_t paymentId;
+    int32_t bookingId;
+    double baseAmount;
+    double extraCharges;
+    double taxRate;
+    int32_t paidOn;
+    int32_t pad;
+};
+
+struct MaintRec {
+    int32_t maintId;
+    int32_t roomId;
+    int32_t status;
+    int32_t pad;
+    StrRef issue;
+    StrRef scheduledDate;
+    int32_t priority;
+    int32_t day;
+    int32_t dueDay;
+    int32_t staffId;
+    int32_t completedOn;
+    int32_t pad2;
+};
+
+} // namespace snap
+
+// Read-only memory-mapped view of a snapshot file
+class SnapshotReader {
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+    std::vector<snap::SnapSection> sections;
+    const snap::SnapSection* strings = nullptr;   // looked up once by open()
+
+    const snap::SnapSection* section(uint32_t kind) const;
+
+    // Record i of a section; readers look their section up once per table
+    template <class Rec>
+    bool record(const snap::SnapSection* s, size_t i, Rec& out) const;
+
+public:
+    SnapshotReader() = default;
+    ~SnapshotReader();
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    size_t count(uint32_t kind) const;
+    std::string_view str(const snap::StrRef& r) const;
+
+    bool readRooms(std::vector<Room>& out) const;
+    // Text fields are copied into pool (maintenance fields interned)
+    bool readCustomers(std::vector<Customer>& out, StringPool& pool) const;
+    bool readBookings(std::vector<Booking>& out) const;
+    bool readPayments(PaymentLedger& out) const;
+    bool readMaintenance(std::vector<Maintenance>& out, StringPool& pool) const;
+};
+
+// Writes a complete snapshot to path via a temp file and rename()
+bool writeSnapshot(const std::string& path,
+                   const std::vector<Room>& rooms,
+                   const std::vector<Customer>& customers,
+                   const std::vector<Booking>& bookings,
+                   const PaymentLedger& payments,
+                   const std::vector<Maintenance>& maintenance);
+
+#endif
@@ -14,6 +14,9 @@ public:
 
     Staff(int id, const std::string &n, const std::string &r, double s)
         : staffId(id), name(n), role(r), salary(s) {}
+
+    // Technicians take maintenance jobs
+    bool isTechnician() const { return role == "Technician"; }
 };
 
 #endif
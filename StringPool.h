@@ -0,0 +1,114 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * Arena for the text fields of customers and maintenance records.
+ * Strings are copied into large blocks and handed out as string_views
+ * that stay valid for the pool's lifetime (blocks never move or shrink).
+ *
+ * store() always copies; intern() returns the existing copy of a value
+ * it has seen before, for low-cardinality fields such as dates and
+ * common maintenance issues. Both are safe to call from several threads.
+ */
+class StringPool {
+public:
+    struct Stats {
+        size_t strings = 0;        // store() + intern() calls
+        size_t bytesUsed = 0;      // payload bytes copied into the arena
+        size_t bytesReserved = 0;  // arena blocks allocated
+        size_t blocks = 0;
+        size_t interned = 0;       // distinct interned values
+        size_t internHits = 0;     // intern() calls that found a copy
+        size_t internTableBytes = 0;
+    };
+
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    StringPool() = default;
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    std::string_view store(std::string_view s) {
+        std::lock_guard<std::mutex> lock(mutex);
+        st.strings++;
+        return copy(s);
+    }
+
+    std::string_view intern(std::string_view s) {
+        std::lock_guard<std::mutex> lock(mutex);
+        st.strings++;
+
+        auto it = internTable.find(s);
+        if (it != internTable.end()) {
+            st.internHits++;
+            return *it;
+        }
+        std::string_view v = copy(s);
+        internTable.insert(v);
+        return v;
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        Stats s = st;
+        s.blocks = blocks.size();
+        s.interned = internTable.size();
+        // Node + bucket estimate for the libstdc++ hash set
+        s.internTableBytes = internTable.size() * (sizeof(std::string_view) + 2 * sizeof(void*)) +
+                             internTable.bucket_count() * sizeof(void*);
+        return s;
+    }
+
+    // Heap bytes a std::string of this length would cost on top of its
+    // own sizeof: nothing within the small-string buffer, otherwise a
+    // malloc chunk (16-byte granularity plus an 8-byte header)
+    static size_t stdStringHeapBytes(size_t len) {
+        if (len < 16) return 0;
+        return (len + 1 + 8 + 15) / 16 * 16;
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* cursor = nullptr;
+    size_t left = 0;
+    std::unordered_set<std::string_view> internTable;
+    Stats st;
+
+    std::string_view copy(std::string_view s) {
+        if (s.empty()) return std::string_view();
+
+        if (s.size() > left) {
+            // Oversized strings get a block of their own so the current
+            // block's tail is not wasted
+            if (s.size() > BLOCK_SIZE / 4) {
+                blocks.emplace_back(new char[s.size()]);
+                st.bytesReserved += s.size();
+                st.bytesUsed += s.size();
+                std::memcpy(blocks.back().get(), s.data(), s.size());
+                return std::string_view(blocks.back().get(), s.size());
+            }
+            blocks.emplace_back(new char[BLOCK_SIZE]);
+            st.bytesReserved += BLOCK_SIZE;
+            cursor = blocks.back().get();
+            left = BLOCK_SIZE;
+        }
+
+        std::memcpy(cursor, s.data(), s.size());
+        std::string_view v(cursor, s.size());
+        cursor += s.size();
+        left -= s.size();
+        st.bytesUsed += s.size();
+        return v;
+    }
+};
+
+#endif
@@ -0,0 +1,109 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <unistd.h>
+
+namespace trace {
+
+/* ================= Recorder ================= */
+
+static constexpr size_t FLUSH_BYTES = 64 * 1024;
+
+bool Recorder::start(const std::string& path) {
+    stop();
+    std::lock_guard<std::mutex> lock(mutex);
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    epochNanos.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now().time_since_epoch()).count(),
+                     std::memory_order_relaxed);
+    on.store(true, std::memory_order_release);
+    return true;
+}
+
+void Recorder::stop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    on.store(false, std::memory_order_relaxed);
+    if (fd < 0) return;
+    flushLocked();
+    ::close(fd);
+    fd = -1;
+}
+
+int64_t Recorder::nowMicros() const {
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return (now - epochNanos.load(std::memory_order_relaxed)) / 1000;
+}
+
+void Recorder::write(const JournalEntry& e) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd < 0) return;
+    buffer += e.encode();
+    if (buffer.size() >= FLUSH_BYTES) flushLocked();
+}
+
+void Recorder::flushLocked() {
+    const char* p = buffer.data();
+    size_t left = buffer.size();
+    while (left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n <= 0) break;
+        p += n;
+        left -= (size_t)n;
+    }
+    buffer.clear();
+}
+
+/* ================= Scope ================= */
+
+thread_local int Scope::depth = 0;
+
+Scope::~Scope() {
+    if (!rec && !nested) return;
+    depth--;
+    if (!rec) return;
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    JournalEntry line;
+    line.add(std::to_string(startMicros)).add(std::to_string(ns));
+    line.add(call.fields[0]).add(result);
+    for (size_t i = 1; i < call.fields.size(); i++) line.add(call.fields[i]);
+    rec->write(line);
+}
+
+/* ================= Reader ================= */
+
+bool load(const std::string& path, std::vector<Call>& out) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+
+    out.clear();
+    std::string line;
+    std::vector<std::string> fields;
+    while (std::getline(f, line)) {
+        if (f.eof() || !JournalEntry::decode(line, fields) || fields.size() < 4) break;
+
+        Call c;
+        c.startMicros = std::atoll(fields[0].c_str());
+        c.recordedNanos = std::atoll(fields[1].c_str());
+        c.op = std::move(fields[2]);
+        c.result = std::move(fields[3]);
+        c.args.assign(std::make_move_iterator(fields.begin() + 4), std::make_move_iterator(fields.end()));
+        out.push_back(std::move(c));
+    }
+
+    // Calls are written as they return, so overlapping ones can be out
+    // of start order
+    std::stable_sort(out.begin(), out.end(),
+                     [](const Call& a, const Call& b) { return a.startMicros < b.startMicros; });
+    return true;
+}
+
+} // namespace trace
@@ -0,0 +1,126 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Journal.h"
+
+/*
+ * Command traces of the public Hotel API, for reproducing a desk's
+ * workload offline (bench/hotel_replay). Every public call is recorded,
+ * reports and saves included, except: the inline accessors and the
+ * lookups that hand out references or raw pointers into the tables
+ * (getRooms, findRoom, getRoomTypeById, ...); rollOverDay, which the
+ * calls that depend on it run themselves; the journal mode switches,
+ * which hotel_replay takes as options; and trace control itself.
+ * importBatch records only its row counts.
+ *
+ * Each call is one line in the journal's encoding, written when the
+ * call returns:
+ *
+ *   start-us  duration-ns  op  result  arg...
+ *
+ * start-us counts from when recording began. result is the return
+ * value (a count for lists, 1/0 for found / not found) or empty for
+ * void calls. Only the outermost traced call on a thread is recorded,
+ * so createBooking does not also log the createReservation it makes.
+ *
+ * Lines are buffered and written in 64 KiB blocks; a crash loses the
+ * tail of the trace, which the reader stops at.
+ */
+namespace trace {
+
+struct Call {
+    int64_t startMicros = 0;
+    int64_t recordedNanos = 0;
+    std::string op;
+    std::string result;
+    std::vector<std::string> args;
+};
+
+// Every intact call in the file, by start time
+bool load(const std::string& path, std::vector<Call>& out);
+
+class Recorder {
+public:
+    ~Recorder() { stop(); }
+
+    bool start(const std::string& path);
+    void stop();
+    bool active() const { return on.load(std::memory_order_acquire); }
+
+    int64_t nowMicros() const;
+    void write(const JournalEntry& e);
+
+private:
+    std::mutex mutex;
+    int fd = -1;
+    std::string buffer;
+    std::atomic<bool> on{false};
+    // steady_clock nanoseconds at start(); set before on, which
+    // publishes it to the threads that check active()
+    std::atomic<int64_t> epochNanos{0};
+
+    void flushLocked();
+};
+
+// One traced call; declare it first thing in the method, with the
+// arguments, and pass return values through ret()
+class Scope {
+public:
+    template <class... A>
+    Scope(Recorder& r, const char* op, const A&... args) {
+        if (!r.active()) return;
+        if (depth++ > 0) {
+            nested = true;
+            return;
+        }
+        rec = &r;
+        startMicros = r.nowMicros();
+        start = std::chrono::steady_clock::now();
+        call.add(op);
+        (call.add(args), ...);
+    }
+
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    template <class T>
+    T ret(T v) {
+        if (rec) result = field(v);
+        return v;
+    }
+
+private:
+    static thread_local int depth;
+
+    Recorder* rec = nullptr;
+    bool nested = false;
+    int64_t startMicros = 0;
+    std::chrono::steady_clock::time_point start;
+    JournalEntry call;   // op and arguments
+    std::string result;
+
+    static std::string field(bool v) { return v ? "1" : "0"; }
+    static std::string field(int v) { return std::to_string(v); }
+    static std::string field(size_t v) { return std::to_string(v); }
+    static std::string field(double v) { return JournalEntry().add(v).fields[0]; }
+    template <class T>
+    static std::string field(const std::vector<T>& v) { return std::to_string(v.size()); }
+    template <class T>
+    static std::string field(const std::optional<T>& v) { return v ? "1" : "0"; }
+    template <class T>
+    static std::string field(const T&) { return ""; }
+};
+
+} // namespace trace
+
+#endif
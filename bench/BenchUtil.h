@@ -0,0 +1,99 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+// Small helpers shared by the benchmark programs: a per-API latency
+// recorder with percentile reporting and a scratch working directory.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+inline double microsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+// Latency samples (microseconds) of one operation kind
+class Recorder {
+public:
+    std::string name;
+    std::vector<double> samples;
+    double wallMicros = 0;   // time spent in this phase, for ops/sec
+
+    explicit Recorder(std::string n = "") : name(std::move(n)) {}
+
+    void add(double us) { samples.push_back(us); }
+
+    // Times fn() once and records it
+    template <class Fn>
+    auto time(Fn&& fn) {
+        auto start = Clock::now();
+        if constexpr (std::is_void_v<decltype(fn())>) {
+            fn();
+            add(microsSince(start));
+        } else {
+            auto r = fn();
+            add(microsSince(start));
+            return r;
+        }
+    }
+
+    double percentile(double p) {
+        if (samples.empty()) return 0;
+        if (!sorted) {
+            std::sort(samples.begin(), samples.end());
+            sorted = true;
+        }
+        return samples[std::min(samples.size() - 1, (size_t)(p * samples.size()))];
+    }
+
+    double total() const {
+        double t = 0;
+        for (double s : samples) t += s;
+        return t;
+    }
+
+private:
+    bool sorted = false;
+};
+
+inline void printHeader() {
+    std::printf("%-22s %10s %12s %10s %10s %10s %12s\n",
+                "operation", "count", "ops/sec", "p50 us", "p90 us", "p99 us", "max us");
+}
+
+// ops/sec uses the phase wall time when set, else the summed latencies
+inline void printRow(Recorder& r) {
+    if (r.samples.empty()) return;
+    double wall = r.wallMicros > 0 ? r.wallMicros : r.total();
+    double opsPerSec = wall > 0 ? r.samples.size() / (wall / 1e6) : 0;
+    std::printf("%-22s %10zu %12.0f %10.2f %10.2f %10.2f %12.2f\n",
+                r.name.c_str(), r.samples.size(), opsPerSec,
+                r.percentile(0.50), r.percentile(0.90), r.percentile(0.99), r.percentile(1.0));
+}
+
+// Creates a fresh directory under /tmp and makes it the working
+// directory, so the .dat / journal files stay out of the source tree
+inline bool enterScratchDir(const char* prefix) {
+    std::string tmpl = std::string("/tmp/") + prefix + "_XXXXXX";
+    std::vector<char> dir(tmpl.begin(), tmpl.end());
+    dir.push_back('\0');
+    if (!mkdtemp(dir.data()) || chdir(dir.data()) != 0) {
+        std::cerr << "Cannot create scratch directory\n";
+        return false;
+    }
+    std::cout << "Working in " << dir.data() << "\n";
+    return true;
+}
+
+} // namespace bench
+
+#endif
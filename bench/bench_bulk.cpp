@@ -0,0 +1,97 @@
+// Bulk onboarding: writes a synthetic property (rooms, guests and a
+// booking history) as CSV or NDJSON, then times parsing, importing
+// (validation, indexes, one snapshot), reloading and exporting.
+//
+//   ./bench_bulk [bookings] [csv|ndjson]
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+
+#include "BenchUtil.h"
+#include "../BulkIO.h"
+#include "../Hotel.h"
+
+using bench::Clock;
+
+int main(int argc, char* argv[]) {
+    size_t count = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    bulk::Format format = (argc > 2 && std::string(argv[2]) == "ndjson") ? bulk::Format::Ndjson
+                                                                        : bulk::Format::Csv;
+    std::string ext = bulk::extension(format);
+    if (!bench::enterScratchDir("hotel_bulk")) return 1;
+
+    // One room per 400 bookings and one guest per 4, all checked out
+    // over the last ten years with a few cancellations
+    size_t rooms = count / 400 + 1, guests = count / 4 + 1;
+    std::vector<Room> roomRows;
+    std::vector<Customer> guestRows;
+    std::vector<Booking> bookingRows;
+    std::vector<std::string> names;
+    for (size_t i = 0; i < rooms; i++) roomRows.emplace_back(1000 + (int)i, 1 + (int)(i % 3), 0.0);
+    names.reserve(guests);
+    for (size_t i = 0; i < guests; i++) {
+        names.push_back("Guest " + std::to_string(i));
+        guestRows.emplace_back(1 + (int)i, names.back(), "555-" + std::to_string(i % 10000), "");
+    }
+
+    std::mt19937 rng(3);
+    int start = today() - 3650;
+    bookingRows.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        Booking b(1 + (int)i, 1 + (int)(rng() % guests), 1000 + (int)(rng() % rooms), 0,
+                  1 + (int)(rng() % 5), start + (int)(rng() % 3640));
+        b.status = (rng() % 10 == 0) ? BookingStatus::Cancelled : BookingStatus::CheckedOut;
+        bookingRows.push_back(b);
+    }
+
+    mkdir("in", 0755);
+    {
+        std::ofstream r("in/rooms" + ext), c("in/customers" + ext), b("in/bookings" + ext);
+        bulk::writeRooms(r, roomRows, format);
+        bulk::writeCustomers(c, guestRows, format);
+        bulk::writeBookings(b, bookingRows, format);
+        std::printf("Input: %zu rooms, %zu guests, %zu bookings (%.0f MB of bookings)\n",
+                    rooms, guests, count, (double)b.tellp() / 1e6);
+    }
+    bookingRows.clear();
+    bookingRows.shrink_to_fit();
+
+    Hotel hotel;
+    bulk::Batch batch;
+
+    auto t0 = Clock::now();
+    bool read = bulk::readRooms("in/rooms" + ext, batch) &&
+                bulk::readCustomers("in/customers" + ext, batch) &&
+                bulk::readBookings("in/bookings" + ext, batch);
+    double parseMs = bench::microsSince(t0) / 1e3;
+
+    t0 = Clock::now();
+    bool ok = read && hotel.importBatch(batch);
+    double importMs = bench::microsSince(t0) / 1e3;
+    if (!ok) {
+        for (const auto& e : batch.errors) std::printf("%s\n", e.c_str());
+        return 1;
+    }
+
+    t0 = Clock::now();
+    Hotel reloaded;
+    double reloadMs = bench::microsSince(t0) / 1e3;
+
+    mkdir("out", 0755);
+    t0 = Clock::now();
+    reloaded.exportTables("out", format);
+    double exportMs = bench::microsSince(t0) / 1e3;
+
+    std::printf("Parse:   %8.0f ms\n"
+                "Import:  %8.0f ms (%zu rooms, %zu guests, %zu bookings, %zu rejected)\n"
+                "Reload:  %8.0f ms (%zu bookings)\n"
+                "Export:  %8.0f ms\n",
+                parseMs, importMs, batch.importedRooms, batch.importedCustomers,
+                batch.importedBookings, batch.rejected, reloadMs, reloaded.getBookings().size(),
+                exportMs);
+    return 0;
+}
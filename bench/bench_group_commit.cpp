@@ -0,0 +1,80 @@
+// Durable write throughput under a burst of concurrent desks: every
+// thread adds a guest, books one of its own rooms and cancels it, over
+// and over. Compares the three persistence modes:
+//
+//   full    - every change rewrites all .dat files (the default)
+//   journal - one journal write + fdatasync per change
+//   group   - group commit, concurrent changes share write + fdatasync
+//
+//   ./bench_group_commit [threads] [opsPerThread] [windowMicros] [maxBatch]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "../Hotel.h"
+
+using bench::Clock;
+
+enum class Mode { Full, Journal, Group };
+
+static void runRound(Mode mode, const char* name, int threads, int ops,
+                     std::chrono::microseconds window, size_t maxBatch) {
+    if (!bench::enterScratchDir("hotel_group")) return;
+
+    Hotel hotel;
+    if (mode == Mode::Journal) hotel.enableJournal(0, true);
+    if (mode == Mode::Group) hotel.enableGroupCommit(window, maxBatch, 0);
+
+    for (int i = 0; i < threads; i++) hotel.addRoom(1 + i % 3);
+    int firstRoom = hotel.getRooms()[hotel.getRooms().size() - (size_t)threads].roomId;
+
+    std::vector<bench::Recorder> rec(threads, bench::Recorder(name));
+    auto worker = [&](int t) {
+        int roomId = firstRoom + t;
+        for (int i = 0; i < ops; i++) {
+            rec[t].time([&] {
+                int cust = hotel.addCustomer("Desk_" + std::to_string(t), "000", "desk@example.com");
+                int bid = hotel.createBooking(cust, roomId, 1);
+                if (bid > 0) hotel.cancelBooking(bid);
+            });
+        }
+    };
+
+    auto start = Clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) pool.emplace_back(worker, t);
+    for (auto& t : pool) t.join();
+
+    bench::Recorder all(name);
+    for (auto& r : rec) all.samples.insert(all.samples.end(), r.samples.begin(), r.samples.end());
+    all.wallMicros = bench::microsSince(start);
+    bench::printRow(all);
+    std::printf("%-22s %10.0f durable changes/sec\n", "",
+                3.0 * (double)all.samples.size() / (all.wallMicros / 1e6));
+
+    // Everything acknowledged must come back after a restart
+    Hotel reloaded;
+    if (reloaded.getCustomers().size() != hotel.getCustomers().size())
+        std::printf("%-22s LOST CHANGES: %zu of %zu customers after reload\n", "",
+                    reloaded.getCustomers().size(), hotel.getCustomers().size());
+}
+
+int main(int argc, char* argv[]) {
+    int threads = (argc > 1) ? std::atoi(argv[1]) : 32;
+    int ops = (argc > 2) ? std::atoi(argv[2]) : 50;
+    std::chrono::microseconds window((argc > 3) ? std::atol(argv[3]) : 200);
+    size_t maxBatch = (argc > 4) ? std::strtoul(argv[4], nullptr, 10) : 256;
+
+    std::printf("%d threads x %d rounds of addCustomer + createBooking + cancelBooking\n",
+                threads, ops);
+    bench::printHeader();
+    runRound(Mode::Full, "full saves", threads, ops, window, maxBatch);
+    runRound(Mode::Journal, "journal, sync each", threads, ops, window, maxBatch);
+    runRound(Mode::Group, "group commit", threads, ops, window, maxBatch);
+    return 0;
+}
@@ -0,0 +1,114 @@
+// Lookup microbenchmark: indexed Hotel::findBooking / hasRoom /
+// hasCustomer versus the linear vector scan they used to do, and guest
+// search (findCustomers by phone, email and name prefix).
+//
+//   cmake --build build --target bench_lookup
+//   ./bench_lookup [bookings] [guests]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unistd.h>
+
+#include "../Hotel.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double nsPerOp(Clock::time_point start, size_t ops) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    return (double)ns / (double)ops;
+}
+
+int main(int argc, char* argv[]) {
+    size_t bookingCount = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t guestCount = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 1000000;
+
+    // Keep the generated .dat / journal files out of the working tree
+    char dir[] = "/tmp/hotel_bench_XXXXXX";
+    if (!mkdtemp(dir) || chdir(dir) != 0) {
+        std::cerr << "Cannot create scratch directory\n";
+        return 1;
+    }
+
+    Hotel hotel;
+    hotel.enableJournal(0, false);
+
+    size_t roomCount = bookingCount;
+    for (size_t i = 0; i < roomCount; i++) hotel.addRoom(1 + (int)(i % 3));
+    int cust = hotel.addCustomer("Bench", "000", "bench@example.com");
+
+    auto t0 = Clock::now();
+    for (const auto& r : hotel.getRooms()) {
+        if ((size_t)hotel.getBookings().size() >= bookingCount) break;
+        if (r.status == RoomStatus::Available) hotel.createBooking(cust, r.roomId, 1);
+    }
+    std::cout << "Created " << hotel.getBookings().size() << " bookings in "
+              << nsPerOp(t0, hotel.getBookings().size()) << " ns/op\n";
+
+    const size_t probes = 200000;
+    const size_t linearProbes = 200;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(1, (int)hotel.getBookings().size());
+
+    // Indexed lookups
+    size_t hits = 0;
+    t0 = Clock::now();
+    for (size_t i = 0; i < probes; i++) {
+        int id = pick(rng);
+        if (hotel.findBooking(id)) hits++;
+        if (hotel.hasRoom(id)) hits++;
+    }
+    double indexed = nsPerOp(t0, probes * 2);
+
+    // Linear scans over the same vectors (the pre-index behaviour)
+    const auto& bookings = hotel.getBookings();
+    const auto& rooms = hotel.getRooms();
+    t0 = Clock::now();
+    for (size_t i = 0; i < linearProbes; i++) {
+        int id = pick(rng);
+        for (const auto& b : bookings)
+            if (b.bookingId == id) { hits++; break; }
+        for (const auto& r : rooms)
+            if (r.roomId == id) { hits++; break; }
+    }
+    double linear = nsPerOp(t0, linearProbes * 2);
+
+    std::cout << "Indexed lookup: " << indexed << " ns/op\n"
+              << "Linear scan:    " << linear << " ns/op\n"
+              << "Speedup:        " << (linear / indexed) << "x\n"
+              << "(hits " << hits << ")\n";
+
+    // Guest search
+    t0 = Clock::now();
+    for (size_t i = 0; i < guestCount; i++) {
+        std::string n = std::to_string(i);
+        hotel.addCustomer("Guest_" + n, "+91-" + n, "guest" + n + "@example.com");
+    }
+    std::cout << "\nAdded " << guestCount << " guests in " << nsPerOp(t0, guestCount) << " ns/op\n";
+
+    const size_t searches = 100000;
+    std::uniform_int_distribution<size_t> guest(0, guestCount ? guestCount - 1 : 0);
+    size_t found = 0;
+    double perKind[3];
+    for (int kind = 0; kind < 3; kind++) {
+        t0 = Clock::now();
+        for (size_t i = 0; i < searches; i++) {
+            std::string n = std::to_string(guest(rng));
+            CustomerQuery q;
+            q.limit = 10;
+            if (kind == 0) q.phone = "91" + n;
+            else if (kind == 1) q.email = "GUEST" + n + "@example.com";
+            else q.namePrefix = "guest_" + n;
+            found += hotel.findCustomers(q).size();
+        }
+        perKind[kind] = nsPerOp(t0, searches);
+    }
+
+    std::cout << "By phone:       " << perKind[0] << " ns/op\n"
+              << "By email:       " << perKind[1] << " ns/op\n"
+              << "By name prefix: " << perKind[2] << " ns/op (up to 10 results)\n"
+              << "(found " << found << ")\n";
+    return 0;
+}
@@ -0,0 +1,108 @@
+// Reports against live traffic: one desk thread books and checks out
+// rooms while a reporting thread scans the whole history over and over.
+// Compares the desk's latency with no reports, with a report that holds
+// the table lock for its whole run (exportTables) and with reports read
+// from a pinned HotelView.
+//
+//   ./bench_reports [bookings] [deskOps]
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+
+#include "BenchUtil.h"
+#include "../BulkIO.h"
+#include "../Hotel.h"
+
+using bench::Clock;
+
+enum class Reporter { None, Locked, Pinned };
+
+int main(int argc, char* argv[]) {
+    size_t count = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    int deskOps = (argc > 2) ? std::atoi(argv[2]) : 20000;
+    if (!bench::enterScratchDir("hotel_reports")) return 1;
+
+    // A checked-out history over 2000 rooms, like bench_bulk
+    Hotel hotel;
+    {
+        bulk::Batch batch;
+        size_t rooms = 2000, guests = count / 4 + 1;
+        std::vector<std::string> names;
+        names.reserve(guests);
+        for (size_t i = 0; i < rooms; i++) batch.rooms.emplace_back(1000 + (int)i, 1 + (int)(i % 3), 0.0);
+        for (size_t i = 0; i < guests; i++) {
+            names.push_back("Guest_" + std::to_string(i));
+            batch.customers.emplace_back(1 + (int)i, names.back(), "555", "");
+        }
+        std::mt19937 rng(5);
+        int start = today() - 3650;
+        for (size_t i = 0; i < count; i++) {
+            Booking b(1 + (int)i, 1 + (int)(rng() % guests), 1000 + (int)(rng() % rooms), 0,
+                      1 + (int)(rng() % 5), start + (int)(rng() % 3640));
+            b.status = BookingStatus::CheckedOut;
+            batch.bookings.push_back(b);
+        }
+        batch.roomLines.assign(batch.rooms.size(), 0);
+        batch.customerLines.assign(batch.customers.size(), 0);
+        batch.bookingLines.assign(batch.bookings.size(), 0);
+        if (!hotel.importBatch(batch)) return 1;
+    }
+    hotel.enableJournal(0, false);
+    int cust = hotel.addCustomer("Desk", "000", "desk@example.com");
+    mkdir("export", 0755);
+
+    std::printf("%zu bookings, desk does %d book + checkout pairs per round\n\n", count, deskOps);
+    bench::printHeader();
+
+    auto round = [&](Reporter mode, const char* name) {
+        std::atomic<bool> done{false};
+        std::atomic<long> reports{0};
+        bench::Recorder pin("  pinView");
+
+        std::thread reporter([&] {
+            while (!done.load(std::memory_order_relaxed)) {
+                if (mode == Reporter::Locked) {
+                    hotel.exportTables("export", bulk::Format::Csv);
+                } else if (mode == Reporter::Pinned) {
+                    // A booking scan off the lock, and the ledger kernel a
+                    // revenue report runs under a brief shared lock
+                    HotelView view = pin.time([&] { return hotel.pinView(); });
+                    size_t stays = 0;
+                    for (const Booking& b : view.bookings) stays += b.days;
+                    auto months = hotel.revenueByMonth(today() - 3650, today() + 1);
+                    if (stays == 0 && months.empty()) std::printf("empty\n");
+                } else {
+                    break;
+                }
+                reports++;
+            }
+        });
+
+        bench::Recorder desk(name);
+        auto start = Clock::now();
+        for (int i = 0; i < deskOps; i++) {
+            desk.time([&] {
+                int bid = hotel.bookAnyRoom(cust, 1 + i % 3, 1);
+                if (bid > 0) hotel.checkoutBooking(bid, 0);
+            });
+        }
+        desk.wallMicros = bench::microsSince(start);
+        done = true;
+        reporter.join();
+
+        bench::printRow(desk);
+        bench::printRow(pin);
+        if (mode != Reporter::None) std::printf("  %ld reports during the round\n", reports.load());
+        hotel.flushInvoices();
+    };
+
+    round(Reporter::None, "no reports");
+    round(Reporter::Locked, "locked report");
+    round(Reporter::Pinned, "pinned view report");
+    return 0;
+}
@@ -0,0 +1,159 @@
+// Revenue aggregation over a large payment history: the array-of-structs
+// pass (Payment::total() per element, booking lookup for the room type)
+// against the PaymentLedger column kernels, and RevPAR by type from the
+// occupancy time series against a rescan, and stay quotes from the
+// precomputed rate tables against evaluating the rate plan per night.
+//
+//   ./bench_revenue [payments]
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "../PaymentLedger.h"
+#include "../OccupancySeries.h"
+#include "../RateEngine.h"
+
+using bench::Clock;
+
+int main(int argc, char* argv[]) {
+    size_t n = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 5000000;
+
+    // Three years of checkouts, one booking per payment
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> type(1, 3), days(1, 7), extra(0, 50), when(0, 3 * 365 - 1);
+    const double price[] = { 0, 3000, 5000, 8000 };
+    int start = daysFromCivil(2023, 1, 1);
+
+    std::vector<Payment> aos;
+    std::unordered_map<int, int> bookingType;   // bookingId -> roomTypeId
+    PaymentLedger ledger;
+    aos.reserve(n);
+    bookingType.reserve(n);
+    ledger.reserve(n);
+
+    for (size_t i = 0; i < n; i++) {
+        int t = type(rng);
+        Payment p((int)i + 1, (int)i + 1, price[t] * days(rng), extra(rng) * 10.0, 0.18, start + when(rng));
+        aos.push_back(p);
+        bookingType.emplace(p.bookingId, t);
+        ledger.push_back(p, t);
+    }
+    std::cout << n << " payments\n";
+
+    // Array of structs, one pass with a booking lookup per payment
+    auto t0 = Clock::now();
+    double aosTotal = 0;
+    std::unordered_map<int, double> aosByType;
+    for (const auto& p : aos) {
+        aosTotal += p.total();
+        aosByType[bookingType[p.bookingId]] += p.total();
+    }
+    double aosMs = bench::microsSince(t0) / 1e3;
+
+    t0 = Clock::now();
+    double total = ledger.sumTotal();
+    double sumMs = bench::microsSince(t0) / 1e3;
+
+    t0 = Clock::now();
+    auto byType = ledger.sumByRoomType();
+    double typeMs = bench::microsSince(t0) / 1e3;
+
+    t0 = Clock::now();
+    auto byMonth = ledger.sumByMonth(start, start + 3 * 365);
+    double monthMs = bench::microsSince(t0) / 1e3;
+
+    std::cout << "AoS total + by type:   " << aosMs << " ms\n"
+              << "Ledger sumTotal:       " << sumMs << " ms\n"
+              << "Ledger sumByRoomType:  " << typeMs << " ms\n"
+              << "Ledger sumByMonth:     " << monthMs << " ms (" << byMonth.size() << " months)\n"
+              << "Totals: " << (long long)aosTotal << " vs " << (long long)total
+              << ", type 1: " << (long long)aosByType[1] << " vs " << (long long)byType[1] << "\n";
+
+    // The same history as stays of 400 rooms per type, each ending on
+    // the day it was paid
+    auto nightsOf = [&](size_t i) { return (int)(ledger.baseAmount[i] / price[ledger.roomTypeId[i]]); };
+    OccupancySeries built, live;
+    t0 = Clock::now();
+    built.beginRebuild();
+    for (int t = 1; t <= 3; t++) built.setRooms(t, 400);
+    for (size_t i = 0; i < n; i++) {
+        int nights = nightsOf(i), checkIn = ledger.paidOn[i] - nights;
+        built.addStay(ledger.roomTypeId[i], checkIn, nights);
+        built.addCheckout(ledger.roomTypeId[i], checkIn, nights, ledger.baseAmount[i], ledger.total(i),
+                          ledger.paidOn[i]);
+    }
+    built.endRebuild();
+    double buildMs = bench::microsSince(t0) / 1e3;
+
+    // Incremental updates, as the booking and checkout paths make them
+    for (int t = 1; t <= 3; t++) live.setRooms(t, 400);
+    for (size_t i = 0; i < n; i++) {
+        int nights = nightsOf(i), checkIn = ledger.paidOn[i] - nights;
+        live.addStay(ledger.roomTypeId[i], checkIn, nights);
+        live.addCheckout(ledger.roomTypeId[i], checkIn, nights, ledger.baseAmount[i], ledger.total(i),
+                         ledger.paidOn[i]);
+    }
+
+    int to = start + 3 * 365, from = to - 365;
+    const int reps = 10000;
+    double revpar[4] = { 0, 0, 0, 0 };
+    t0 = Clock::now();
+    for (int r = 0; r < reps; r++)
+        for (int t = 1; t <= 3; t++) revpar[t] += built.total(t, from, to).revpar();
+    double queryUs = bench::microsSince(t0) / reps;
+
+    // Rescan: spread every stay's base over its nights inside the range
+    t0 = Clock::now();
+    double scan[4] = { 0, 0, 0, 0 };
+    for (size_t i = 0; i < n; i++) {
+        int nights = nightsOf(i), checkIn = ledger.paidOn[i] - nights;
+        int inside = std::min(to, checkIn + nights) - std::max(from, checkIn);
+        if (inside > 0) scan[ledger.roomTypeId[i]] += ledger.baseAmount[i] / nights * inside;
+    }
+    double scanMs = bench::microsSince(t0) / 1e3;
+
+    std::cout << "Occupancy rebuild:     " << buildMs << " ms\n"
+              << "RevPAR by type, 365d:  " << queryUs << " us (series) vs " << scanMs << " ms (rescan)\n";
+    for (int t = 1; t <= 3; t++) {
+        std::cout << "  type " << t << ": " << revpar[t] / reps << " vs " << scan[t] / (400.0 * 365)
+                  << ", incremental " << live.total(t, from, to).revpar() << "\n";
+    }
+
+    // A plan with a season per half month, occupancy tiers per type and
+    // stay discounts; tables cover the last year of the history
+    RatePlan plan;
+    for (int m = 1; m <= 12; m++) {
+        plan.seasons.push_back({ m, 1, m, 15, 1.0 + m * 0.02, 0 });
+        plan.seasons.push_back({ m, 16, m, 31, 1.1 + m * 0.02, 0 });
+    }
+    for (int t = 1; t <= 3; t++)
+        for (int pct = 10; pct <= 90; pct += 20) plan.occupancy.push_back({ (double)pct, 1.0 + pct / 200.0, t });
+    plan.stays = { { 3, 0.95 }, { 7, 0.9 }, { 14, 0.85 } };
+
+    RateEngine rates;
+    rates.setPlan(plan);
+    t0 = Clock::now();
+    rates.rebuild({ 1, 2, 3 }, from, built);
+    double tablesMs = bench::microsSince(t0) / 1e3;
+
+    // Same stays inside the tables and past their horizon (rules per night)
+    const int quotes = 200000;
+    double tabled = 0, evaluated = 0;
+    t0 = Clock::now();
+    for (int q = 0; q < quotes; q++) tabled += rates.quote(1 + q % 3, 3000, from + q % 300, 7, built);
+    double tabledNs = bench::microsSince(t0) * 1e3 / quotes;
+    int past = from + RateEngine::HORIZON;
+    t0 = Clock::now();
+    for (int q = 0; q < quotes; q++) evaluated += rates.quote(1 + q % 3, 3000, past + q % 300, 7, built);
+    double evaluatedNs = bench::microsSince(t0) * 1e3 / quotes;
+
+    std::cout << "Rate tables rebuild:   " << tablesMs << " ms (" << RateEngine::HORIZON << " days x 3 types)\n"
+              << "7-night quote:         " << tabledNs << " ns (tables) vs " << evaluatedNs
+              << " ns (rules), avg " << tabled / quotes << " / " << evaluated / quotes << "\n";
+    return 0;
+}
@@ -0,0 +1,256 @@
+// Synthetic load benchmark for the Hotel core.
+//
+// Builds a hotel of --rooms rooms, fills it with --history bookings
+// (checked out or cancelled as occupancy allows, so payments pile up
+// too), then replays --ops operations drawn from a booking / cancel /
+// checkout mix and reports ops/sec and latency percentiles per API.
+// Finally exportToJSON, saveAll and loadAll are timed on the full data.
+//
+//   ./hotel_bench [--rooms N] [--history N] [--ops N] [--repeat N]
+//                 [--mix book=30,any=15,reserve=10,cancel=10,checkout=25,lookup=5,avail=5]
+//                 [--seed N] [--sync] [--snapshot]
+//
+// --sync fsyncs every journal append, --snapshot saves and loads the
+// binary hotel.snap instead of the .dat files.
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "../Hotel.h"
+
+using bench::Clock;
+using bench::Recorder;
+
+struct Options {
+    size_t rooms = 10000;
+    size_t history = 100000;
+    size_t ops = 200000;
+    int repeat = 3;
+    unsigned seed = 42;
+    bool sync = false;
+    bool snapshot = false;
+    std::map<std::string, int> mix = {
+        {"book", 30}, {"any", 15}, {"reserve", 10}, {"cancel", 10},
+        {"checkout", 25}, {"lookup", 5}, {"avail", 5},
+    };
+};
+
+static bool parseMix(const std::string& text, std::map<std::string, int>& mix) {
+    std::map<std::string, int> out;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        std::string name = item.substr(0, eq);
+        if (!mix.count(name)) return false;
+        out[name] = std::atoi(item.c_str() + eq + 1);
+    }
+    for (auto& m : mix) m.second = out.count(m.first) ? out[m.first] : 0;
+    return true;
+}
+
+static bool parseArgs(int argc, char* argv[], Options& o) {
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (a == "--rooms" && hasValue) o.rooms = std::strtoul(argv[++i], nullptr, 10);
+        else if (a == "--history" && hasValue) o.history = std::strtoul(argv[++i], nullptr, 10);
+        else if (a == "--ops" && hasValue) o.ops = std::strtoul(argv[++i], nullptr, 10);
+        else if (a == "--repeat" && hasValue) o.repeat = std::atoi(argv[++i]);
+        else if (a == "--seed" && hasValue) o.seed = (unsigned)std::atoi(argv[++i]);
+        else if (a == "--mix" && hasValue) {
+            if (!parseMix(argv[++i], o.mix)) return false;
+        }
+        else if (a == "--sync") o.sync = true;
+        else if (a == "--snapshot") o.snapshot = true;
+        else return false;
+    }
+    return o.rooms > 0 && o.repeat > 0;
+}
+
+// Confirmed bookings the driver may cancel or check out
+class ActiveSet {
+public:
+    void add(int id) { ids.push_back(id); }
+    size_t size() const { return ids.size(); }
+
+    // Removes and returns a random member, or -1 when empty
+    int take(std::mt19937& rng) {
+        if (ids.empty()) return -1;
+        size_t i = std::uniform_int_distribution<size_t>(0, ids.size() - 1)(rng);
+        int id = ids[i];
+        ids[i] = ids.back();
+        ids.pop_back();
+        return id;
+    }
+
+private:
+    std::vector<int> ids;
+};
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        std::cerr << "usage: hotel_bench [--rooms N] [--history N] [--ops N] [--repeat N]\n"
+                     "                   [--mix book=..,any=..,reserve=..,cancel=..,checkout=..,lookup=..,avail=..]\n"
+                     "                   [--seed N] [--sync] [--snapshot]\n";
+        return 2;
+    }
+    if (!bench::enterScratchDir("hotel_bench")) return 1;
+
+    std::mt19937 rng(opt.seed);
+    Hotel hotel;
+    hotel.enableJournal(0, opt.sync);
+
+    /* ---------- Synthetic hotel ---------- */
+
+    auto t0 = Clock::now();
+    std::vector<int> typeIds;
+    for (const auto& rt : hotel.getRoomTypes()) typeIds.push_back(rt.typeId);
+
+    // Roughly 60% of rooms of the first type, 30% / 10% of the others
+    std::discrete_distribution<size_t> typeMix({ 6, 3, 1 });
+    while (hotel.getRooms().size() < opt.rooms)
+        hotel.addRoom(typeIds[typeMix(rng) % typeIds.size()]);
+
+    std::vector<int> roomIds;
+    for (const auto& r : hotel.getRooms()) roomIds.push_back(r.roomId);
+
+    size_t customerCount = std::max<size_t>(100, opt.rooms / 4);
+    std::vector<int> custIds;
+    for (size_t i = 0; i < customerCount; i++) {
+        std::string n = std::to_string(i);
+        custIds.push_back(hotel.addCustomer("Guest_" + n, "555" + n, "guest" + n + "@example.com"));
+    }
+
+    auto pickRoom = [&]() { return roomIds[std::uniform_int_distribution<size_t>(0, roomIds.size() - 1)(rng)]; };
+    auto pickCust = [&]() { return custIds[std::uniform_int_distribution<size_t>(0, custIds.size() - 1)(rng)]; };
+    auto pickType = [&]() { return typeIds[std::uniform_int_distribution<size_t>(0, typeIds.size() - 1)(rng)]; };
+    auto pickDays = [&]() { return std::uniform_int_distribution<int>(1, 7)(rng); };
+    auto pickExtra = [&]() { return (double)std::uniform_int_distribution<int>(0, 50)(rng) * 10.0; };
+
+    // History: keep occupancy around 70%, retiring stays mostly by checkout
+    ActiveSet active;
+    size_t target = std::max<size_t>(1, opt.rooms * 7 / 10);
+    while (hotel.getBookings().size() < opt.history) {
+        if (active.size() >= target) {
+            int id = active.take(rng);
+            if (std::uniform_int_distribution<int>(0, 9)(rng) < 8) hotel.checkoutBooking(id, pickExtra());
+            else hotel.cancelBooking(id);
+            continue;
+        }
+        int id = hotel.bookAnyRoom(pickCust(), pickType(), pickDays());
+        if (id > 0) active.add(id);
+        else if (active.size() > 0) hotel.checkoutBooking(active.take(rng), 0.0);
+    }
+    hotel.checkpoint();
+
+    std::cout << "Generated " << hotel.getRooms().size() << " rooms, "
+              << hotel.getCustomers().size() << " customers, "
+              << hotel.getBookings().size() << " bookings ("
+              << active.size() << " active) in "
+              << bench::microsSince(t0) / 1e6 << " s\n\n";
+
+    /* ---------- Operation mix ---------- */
+
+    std::vector<std::string> names;
+    std::vector<int> weights;
+    for (const auto& m : opt.mix) {
+        names.push_back(m.first);
+        weights.push_back(m.second);
+    }
+    std::discrete_distribution<size_t> pickOp(weights.begin(), weights.end());
+
+    std::map<std::string, Recorder> rec;
+    rec["book"].name = "createBooking";
+    rec["any"].name = "bookAnyRoom";
+    rec["reserve"].name = "createReservation";
+    rec["cancel"].name = "cancelBooking";
+    rec["checkout"].name = "checkoutBooking";
+    rec["lookup"].name = "getBooking";
+    rec["avail"].name = "findAvailableRooms";
+
+    int now = today();
+    size_t failed = 0;
+    t0 = Clock::now();
+    for (size_t i = 0; i < opt.ops; i++) {
+        const std::string& op = names[pickOp(rng)];
+        Recorder& r = rec[op];
+
+        if (op == "book" || op == "any" || op == "reserve") {
+            int cust = pickCust(), days = pickDays(), id;
+            if (op == "book") {
+                int room = pickRoom();
+                id = r.time([&] { return hotel.createBooking(cust, room, days); });
+            } else if (op == "any") {
+                int type = pickType();
+                id = r.time([&] { return hotel.bookAnyRoom(cust, type, days); });
+            } else {
+                int room = pickRoom();
+                int in = now + std::uniform_int_distribution<int>(1, 180)(rng);
+                id = r.time([&] { return hotel.createReservation(cust, room, in, days); });
+            }
+            if (id > 0) active.add(id);
+            else failed++;
+        } else if (op == "cancel" || op == "checkout") {
+            int id = active.take(rng);
+            if (id < 0) continue;
+            double extra = pickExtra();
+            bool ok = (op == "cancel") ? r.time([&] { return hotel.cancelBooking(id); })
+                                       : r.time([&] { return hotel.checkoutBooking(id, extra); });
+            if (!ok) failed++;
+        } else if (op == "lookup") {
+            int id = std::uniform_int_distribution<int>(1, (int)hotel.getBookings().size())(rng);
+            r.time([&] { return hotel.getBooking(id).has_value(); });
+        } else {
+            int type = pickType();
+            int from = now + std::uniform_int_distribution<int>(0, 90)(rng);
+            int to = from + pickDays();
+            r.time([&] { return hotel.findAvailableRooms(type, from, to).size(); });
+        }
+    }
+    double mixMicros = bench::microsSince(t0);
+
+    std::cout << "Mix: " << opt.ops << " ops in " << mixMicros / 1e6 << " s ("
+              << (size_t)(opt.ops / (mixMicros / 1e6)) << " ops/sec overall, "
+              << failed << " rejected)\n";
+    bench::printHeader();
+    for (auto& r : rec) bench::printRow(r.second);
+
+    /* ---------- Whole-hotel operations ---------- */
+
+    if (opt.snapshot && !hotel.convertToBinarySnapshot()) {
+        std::cerr << "Could not write hotel.snap\n";
+        return 1;
+    }
+
+    // Leave an empty journal so loadAll measures the table load only
+    hotel.checkpoint();
+    Hotel copy;
+
+    Recorder exportRec("exportToJSON"), saveRec("saveAll"), loadRec("loadAll");
+    for (int i = 0; i < opt.repeat; i++) {
+        exportRec.time([&] { return hotel.exportToJSON("dashboard_data.json"); });
+        saveRec.time([&] { hotel.saveAll(); });
+        loadRec.time([&] { copy.loadAll(); });
+    }
+    if (copy.getBookings().size() != hotel.getBookings().size())
+        std::cerr << "loadAll read " << copy.getBookings().size() << " of "
+                  << hotel.getBookings().size() << " bookings\n";
+
+    std::cout << "\nWhole-hotel operations (" << opt.repeat << " runs)\n";
+    bench::printHeader();
+    bench::printRow(exportRec);
+    bench::printRow(saveRec);
+    bench::printRow(loadRec);
+    return 0;
+}
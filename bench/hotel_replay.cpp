@@ -0,0 +1,389 @@
+// Replays a command trace (hotel --trace FILE, see Trace.h) against a
+// copy of a property's data and reports throughput and latency per API
+// call, next to the latencies that were recorded.
+//
+//   ./hotel_replay TRACE [DATA_DIR] [--max] [--speed X] [--threads N]
+//                  [--journal | --group-commit]
+//
+// Calls are issued at their recorded times by default; --speed 2 plays
+// the trace twice as fast and --max back to back. --threads N replays N
+// copies of the trace at once on one hotel. Setup calls (room types,
+// rooms, staff, the rate plan) are replayed too. IDs created during the
+// replay (rooms, customers, bookings, maintenance jobs) are mapped from
+// the recorded ones per copy, so later calls touch the records their
+// copy made. DATA_DIR is copied into a scratch directory first, so every
+// replay starts from the same state and the original is never touched;
+// without it the replay starts from a new hotel. Reports print into a
+// discarding stream, and exports and invoices are written under the
+// scratch directory whatever path was recorded. importBatch is skipped:
+// the trace holds only its row counts.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <filesystem>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "../BulkIO.h"
+#include "../Hotel.h"
+#include "../JsonWriter.h"
+#include "../Trace.h"
+
+using bench::Clock;
+
+namespace {
+
+// Takes the reports' output so that they cost what they did on the desk
+// without flooding the terminal
+class DiscardBuf : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+// A recorded output path, moved under the scratch directory
+std::string scratchPath(const std::string& recorded, const char* dir) {
+    return std::string(dir) + "/" + std::filesystem::path(recorded).filename().string();
+}
+
+// Issues recorded calls against a hotel, translating recorded IDs into
+// the ones this replay created
+class Player {
+public:
+    explicit Player(Hotel& h) : hotel(h) {}
+
+    // Returns false for an unknown op or too few arguments
+    bool play(const trace::Call& c, std::string& result);
+
+private:
+    Hotel& hotel;
+    std::unordered_map<int, int> customers, bookings, jobs, rooms;
+
+    static int lookup(const std::unordered_map<int, int>& ids, int recorded) {
+        auto it = ids.find(recorded);
+        return it != ids.end() ? it->second : recorded;
+    }
+    static void learn(std::unordered_map<int, int>& ids, const std::string& recorded, int got) {
+        int r = std::atoi(recorded.c_str());
+        if (r > 0 && got > 0) ids[r] = got;
+    }
+};
+
+bool Player::play(const trace::Call& c, std::string& result) {
+    const auto& a = c.args;
+    auto num = [&](size_t i) { return std::atoi(a[i].c_str()); };
+    auto real = [&](size_t i) { return std::strtod(a[i].c_str(), nullptr); };
+    auto need = [&](size_t n) { return a.size() >= n; };
+    auto id = [&](int v) {
+        result = std::to_string(v);
+        return v;
+    };
+    auto flag = [&](bool v) { result = v ? "1" : "0"; };
+    result.clear();
+
+    const std::string& op = c.op;
+    if (op == "addCustomer" && need(3)) {
+        learn(customers, c.result, id(hotel.addCustomer(a[0], a[1], a[2])));
+    } else if (op == "findCustomers" && need(4)) {
+        CustomerQuery q;
+        q.phone = a[0];
+        q.email = a[1];
+        q.namePrefix = a[2];
+        q.limit = (size_t)num(3);
+        result = std::to_string(hotel.findCustomers(q).size());
+    } else if (op == "createBooking" && need(3)) {
+        learn(bookings, c.result,
+              id(hotel.createBooking(lookup(customers, num(0)), lookup(rooms, num(1)), num(2))));
+    } else if (op == "createReservation" && need(4)) {
+        learn(bookings, c.result,
+              id(hotel.createReservation(lookup(customers, num(0)), lookup(rooms, num(1)), num(2), num(3))));
+    } else if (op == "bookAnyRoom" && need(3)) {
+        learn(bookings, c.result, id(hotel.bookAnyRoom(lookup(customers, num(0)), num(1), num(2))));
+    } else if (op == "findAvailableRooms" && need(3)) {
+        result = std::to_string(hotel.findAvailableRooms(num(0), num(1), num(2)).size());
+    } else if (op == "cancelBooking" && need(1)) {
+        flag(hotel.cancelBooking(lookup(bookings, num(0))));
+    } else if (op == "checkoutBooking" && need(2)) {
+        flag(hotel.checkoutBooking(lookup(bookings, num(0)), real(1)));
+    } else if (op == "getBooking" && need(1)) {
+        flag(hotel.getBooking(lookup(bookings, num(0))).has_value());
+    } else if (op == "quoteStay" && need(3)) {
+        result = JournalEntry().add(hotel.quoteStay(lookup(rooms, num(0)), num(1), num(2))).fields[0];
+    } else if (op == "quoteType" && need(3)) {
+        result = JournalEntry().add(hotel.quoteType(num(0), num(1), num(2))).fields[0];
+    } else if (op == "scheduleMaintenance" && need(4) && isMaintPriority(num(3))) {
+        learn(jobs, c.result, id(hotel.scheduleMaintenance(lookup(rooms, num(0)), a[1], a[2], (MaintPriority)num(3))));
+    } else if (op == "dispatchMaintenance") {
+        id(hotel.dispatchMaintenance());
+    } else if (op == "completeMaintenance" && need(1)) {
+        flag(hotel.completeMaintenance(lookup(jobs, num(0))));
+    } else if (op == "toggleRoomMaintenance" && need(1)) {
+        id(hotel.toggleRoomMaintenance(lookup(rooms, num(0))));
+    } else if (op == "occupancySeries" && need(4)) {
+        result = std::to_string(hotel.occupancySeries(num(0), num(1), num(2), (Resolution)num(3)).size());
+    } else if (op == "occupancyTotal" && need(3)) {
+        hotel.occupancyTotal(num(0), num(1), num(2));
+    } else if (op == "addRoomType" && need(4)) {
+        // Every copy adds its rooms, but the type only once
+        if (!hotel.getRoomTypeById(num(0))) hotel.addRoomType(RoomType(num(0), a[1], real(2), a[3]));
+    } else if (op == "addRoom" && need(2)) {
+        learn(rooms, c.result, id(hotel.addRoom(num(0), real(1))));
+    } else if (op == "addStaff" && need(3)) {
+        id(hotel.addStaff(a[0], a[1], real(2)));
+    } else if (op == "setCustomerDedup" && need(1)) {
+        hotel.setCustomerDedup(num(0) != 0);
+    } else if (op == "setRatePlan" && need(1)) {
+        RatePlan plan;
+        std::istringstream rules(a[0]);
+        parseRatePlan(rules, "trace", plan);
+        hotel.setRatePlan(plan);
+    } else if (op == "initDefaultData") {
+        hotel.initDefaultData();
+
+    // Lookups and counts
+    } else if (op == "getRoom" && need(1)) {
+        flag(hotel.getRoom(lookup(rooms, num(0))).has_value());
+    } else if (op == "hasRoom" && need(1)) {
+        flag(hotel.hasRoom(lookup(rooms, num(0))));
+    } else if (op == "hasCustomer" && need(1)) {
+        flag(hotel.hasCustomer(lookup(customers, num(0))));
+    } else if (op == "hasBooking" && need(1)) {
+        flag(hotel.hasBooking(lookup(bookings, num(0))));
+    } else if (op == "freeRoomCount" && need(1)) {
+        result = std::to_string(hotel.freeRoomCount(num(0)));
+    } else if (op == "openMaintenance") {
+        result = std::to_string(hotel.openMaintenance().size());
+    } else if (op == "getStaff") {
+        result = std::to_string(hotel.getStaff().size());
+    } else if (op == "countAvailableRooms") {
+        id(hotel.countAvailableRooms());
+    } else if (op == "countBookedRooms") {
+        id(hotel.countBookedRooms());
+    } else if (op == "countMaintenanceRooms") {
+        id(hotel.countMaintenanceRooms());
+    } else if (op == "estimatedRevenueActive") {
+        result = JournalEntry().add(hotel.estimatedRevenueActive()).fields[0];
+    } else if (op == "completedRevenue") {
+        result = JournalEntry().add(hotel.completedRevenue()).fields[0];
+    } else if (op == "revenueByMonth" && need(2)) {
+        result = std::to_string(hotel.revenueByMonth(num(0), num(1)).size());
+    } else if (op == "pinView") {
+        hotel.pinView();
+
+    // Reports and exports
+    } else if (op == "printRooms") {
+        hotel.printRooms();
+    } else if (op == "printCustomers") {
+        hotel.printCustomers();
+    } else if (op == "printBookings") {
+        hotel.printBookings();
+    } else if (op == "showDashboard") {
+        hotel.showDashboard();
+    } else if (op == "printRoomsReport") {
+        hotel.printRoomsReport();
+    } else if (op == "printCustomerReport") {
+        hotel.printCustomerReport();
+    } else if (op == "printRevenueReport") {
+        hotel.printRevenueReport();
+    } else if (op == "printOccupancyReport") {
+        hotel.printOccupancyReport();
+    } else if (op == "printMaintenanceQueue") {
+        hotel.printMaintenanceQueue();
+    } else if (op == "printMemoryReport") {
+        hotel.printMemoryReport();
+    } else if (op == "writeDashboardJSON") {
+        JsonWriter w;
+        hotel.writeDashboardJSON(w);
+    } else if (op == "dashboardJSON") {
+        hotel.dashboardJSON();
+    } else if (op == "exportToJSON" && need(2)) {
+        flag(hotel.exportToJSON(scratchPath(a[0], "dashboard"), num(1) != 0));
+    } else if (op == "generateDashboardHTML") {
+        hotel.generateDashboardHTML();
+    } else if (op == "exportTables" && need(2)) {
+        std::filesystem::create_directories("export");
+        flag(hotel.exportTables("export", (bulk::Format)num(1)));
+    } else if (op == "writeInvoices" && need(2)) {
+        std::vector<int> ids;
+        std::stringstream list(a[0]);
+        std::string one;
+        while (std::getline(list, one, ','))
+            ids.push_back(lookup(bookings, std::atoi(one.c_str())));
+        result = std::to_string(hotel.writeInvoices(ids, scratchPath(a[1], "invoices")));
+    } else if (op == "writeInvoicesForDay" && need(2)) {
+        result = std::to_string(hotel.writeInvoicesForDay(num(0), scratchPath(a[1], "invoices")));
+    } else if (op == "flushInvoices") {
+        hotel.flushInvoices();
+
+    // Persistence
+    } else if (op == "checkpoint") {
+        hotel.checkpoint();
+    } else if (op == "saveAll") {
+        hotel.saveAll();
+    } else if (op == "loadAll") {
+        hotel.loadAll();
+    } else if (op == "convertToBinarySnapshot") {
+        flag(hotel.convertToBinarySnapshot());
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// New IDs differ between runs; only success against failure counts
+bool sameOutcome(const trace::Call& c, const std::string& got) {
+    static const char* const CREATES[] = { "addCustomer", "createBooking", "createReservation",
+                                           "bookAnyRoom", "scheduleMaintenance", "dispatchMaintenance",
+                                           "addRoom", "addStaff" };
+    for (const char* op : CREATES)
+        if (c.op == op) return (std::atoi(c.result.c_str()) > 0) == (std::atoi(got.c_str()) > 0);
+    return c.result == got;
+}
+
+struct Copy {
+    std::map<std::string, bench::Recorder> ops;
+    long diverged = 0;
+    long unknown = 0;
+    double maxLagMicros = 0;
+};
+
+void printTable(std::map<std::string, bench::Recorder>& ops, double wallMicros) {
+    bench::printHeader();
+    bench::Recorder all("all");
+    for (auto& [name, r] : ops) {
+        r.wallMicros = wallMicros;
+        bench::printRow(r);
+        all.samples.insert(all.samples.end(), r.samples.begin(), r.samples.end());
+    }
+    all.wallMicros = wallMicros;
+    bench::printRow(all);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s TRACE [DATA_DIR] [--max] [--speed X] [--threads N] "
+                             "[--journal | --group-commit]\n", argv[0]);
+        return 1;
+    }
+
+    std::string tracePath = std::filesystem::absolute(argv[1]).string();
+    std::string dataDir;
+    double speed = 1.0;
+    bool max = false, journal = false, grouped = false;
+    int threads = 1;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--max") max = true;
+        else if (arg == "--speed" && i + 1 < argc) speed = std::atof(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--journal") journal = true;
+        else if (arg == "--group-commit") grouped = true;
+        else if (dataDir.empty() && arg[0] != '-') dataDir = std::filesystem::absolute(arg).string();
+        else std::fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+    }
+    if (speed <= 0) speed = 1.0;
+
+    std::vector<trace::Call> calls;
+    if (!trace::load(tracePath, calls) || calls.empty()) {
+        std::fprintf(stderr, "No calls in %s\n", tracePath.c_str());
+        return 1;
+    }
+    if (!bench::enterScratchDir("hotel_replay")) return 1;
+
+    if (!dataDir.empty()) {
+        std::error_code ec;
+        std::filesystem::copy(dataDir, "data", std::filesystem::copy_options::recursive, ec);
+        if (ec) {
+            std::fprintf(stderr, "Cannot copy %s: %s\n", dataDir.c_str(), ec.message().c_str());
+            return 1;
+        }
+    }
+
+    Hotel hotel("data");
+    if (grouped) hotel.enableGroupCommit();
+    else if (journal) hotel.enableJournal();
+
+    double span = calls.back().startMicros / 1e6;
+    char pace[32];
+    if (max) std::snprintf(pace, sizeof(pace), "max speed");
+    else std::snprintf(pace, sizeof(pace), "%gx recorded speed", speed);
+    std::printf("%zu calls over %.1f s recorded; %d cop%s at %s\n\n", calls.size(), span, threads,
+                threads == 1 ? "y" : "ies", pace);
+
+    std::printf("Recorded\n");
+    std::map<std::string, bench::Recorder> recorded;
+    for (const auto& c : calls) {
+        bench::Recorder& r = recorded[c.op];
+        r.name = c.op;
+        r.add(c.recordedNanos / 1e3);
+    }
+    printTable(recorded, span * 1e6);
+
+    DiscardBuf discard;
+    std::streambuf* console = std::cout.rdbuf(&discard);
+
+    std::vector<Copy> copies(threads);
+    auto start = Clock::now();
+    auto replay = [&](Copy& copy) {
+        Player player(hotel);
+        std::string result;
+        for (const auto& c : calls) {
+            if (!max) {
+                auto due = start + std::chrono::microseconds((int64_t)(c.startMicros / speed));
+                std::this_thread::sleep_until(due);
+                copy.maxLagMicros = std::max(copy.maxLagMicros, bench::microsSince(due));
+            }
+
+            bench::Recorder& r = copy.ops[c.op];
+            r.name = c.op;
+            bool known = r.time([&] { return player.play(c, result); });
+            if (!known) {
+                r.samples.pop_back();
+                copy.unknown++;
+            } else if (!sameOutcome(c, result)) {
+                copy.diverged++;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(replay, std::ref(copies[t]));
+    replay(copies[0]);
+    for (auto& t : pool) t.join();
+    double wall = bench::microsSince(start);
+    std::cout.rdbuf(console);
+
+    std::map<std::string, bench::Recorder> replayed;
+    long diverged = 0, unknown = 0;
+    double lag = 0;
+    for (auto& copy : copies) {
+        for (auto& [name, r] : copy.ops) {
+            bench::Recorder& all = replayed[name];
+            all.name = name;
+            all.samples.insert(all.samples.end(), r.samples.begin(), r.samples.end());
+        }
+        diverged += copy.diverged;
+        unknown += copy.unknown;
+        lag = std::max(lag, copy.maxLagMicros);
+    }
+
+    std::printf("\nReplayed\n");
+    printTable(replayed, wall);
+    std::printf("\n%.0f calls/sec over %.2f s", calls.size() * threads / (wall / 1e6), wall / 1e6);
+    if (!max) std::printf(", at most %.1f ms behind the recorded schedule", lag / 1e3);
+    std::printf("\n%ld call(s) returned a different outcome than recorded", diverged);
+    if (unknown) std::printf(", %ld skipped (unknown op or importBatch)", unknown);
+    std::printf("\n");
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Closed-loop HTTP load generator for the embedded API server.
+// Each thread keeps one keep-alive connection and issues requests
+// back to back; latency percentiles are reported over all requests.
+//
+//   cmake --build build --target http_load
+//   ./http_load [port] [threads] [seconds] [path]
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static int connectTo(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+// Reads one response with a Content-Length body; false on error
+static bool readResponse(int fd, std::string& buf) {
+    while (true) {
+        size_t headerEnd = buf.find("\r\n\r\n");
+        if (headerEnd != std::string::npos) {
+            size_t cl = buf.find("Content-Length: ");
+            size_t len = (cl != std::string::npos && cl < headerEnd)
+                             ? std::strtoul(buf.c_str() + cl + 16, nullptr, 10) : 0;
+            size_t total = headerEnd + 4 + len;
+            if (buf.size() >= total) {
+                buf.erase(0, total);
+                return true;
+            }
+        }
+
+        char tmp[16384];
+        ssize_t n = ::read(fd, tmp, sizeof(tmp));
+        if (n <= 0) return false;
+        buf.append(tmp, (size_t)n);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int port = (argc > 1) ? std::atoi(argv[1]) : 8080;
+    int threads = (argc > 2) ? std::atoi(argv[2]) : 4;
+    int seconds = (argc > 3) ? std::atoi(argv[3]) : 5;
+    std::string path = (argc > 4) ? argv[4] : "/api/dashboard";
+
+    std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    std::vector<std::vector<double>> latencies(threads);
+    std::atomic<long> errors{0};
+    auto deadline = Clock::now() + std::chrono::seconds(seconds);
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t]() {
+            int fd = connectTo(port);
+            if (fd < 0) {
+                errors++;
+                return;
+            }
+
+            std::string buf;
+            while (Clock::now() < deadline) {
+                auto start = Clock::now();
+                if (::send(fd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size() ||
+                    !readResponse(fd, buf)) {
+                    errors++;
+                    break;
+                }
+                latencies[t].push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            }
+            ::close(fd);
+        });
+    }
+    for (auto& t : pool) t.join();
+
+    std::vector<double> all;
+    for (auto& l : latencies) all.insert(all.end(), l.begin(), l.end());
+    if (all.empty()) {
+        std::cerr << "No successful requests (is the server running on port " << port << "?)\n";
+        return 1;
+    }
+    std::sort(all.begin(), all.end());
+
+    auto pct = [&](double p) { return all[std::min(all.size() - 1, (size_t)(p * all.size()))]; };
+    std::cout << "Requests:   " << all.size() << " (" << errors << " errors)\n"
+              << "Throughput: " << (long)(all.size() / (double)seconds) << " req/s\n"
+              << "Latency us: p50 " << pct(0.50) << ", p90 " << pct(0.90)
+              << ", p99 " << pct(0.99) << ", max " << all.back() << "\n";
+    return 0;
+}
@@ -0,0 +1,129 @@
+// Concurrency stress test: N threads book, cancel and check out rooms on
+// one Hotel and we verify that no room is ever held by two Confirmed
+// bookings. Throughput is reported for 1, 2, 4, ... up to N threads.
+//
+//   cmake --build build --target stress_concurrent
+//   ./stress_concurrent [maxThreads] [opsPerThread] [rooms]
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "../Hotel.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    double opsPerSec;
+    long violations;
+};
+
+static Result runRound(int threads, int opsPerThread, int roomCount) {
+    Hotel hotel;
+    hotel.enableJournal(0, false);
+
+    for (int i = 0; i < roomCount; i++) hotel.addRoom(1 + i % 3);
+    int firstRoom = hotel.getRooms().front().roomId;
+    int lastRoom = hotel.getRooms().back().roomId;
+    int cust = hotel.addCustomer("Stress", "000", "stress@example.com");
+
+    // occupancy[room] counts bookings we believe hold the room; a thread
+    // decrements before releasing, so any value above 1 is a double booking
+    std::unique_ptr<std::atomic<int>[]> occupancy(new std::atomic<int>[lastRoom + 1]);
+    for (int i = 0; i <= lastRoom; i++) occupancy[i] = 0;
+    std::atomic<long> violations{0};
+    std::atomic<long> ops{0};
+
+    auto worker = [&](int seed) {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> pickRoom(firstRoom, lastRoom);
+        std::uniform_int_distribution<int> pickType(1, 3);
+        std::vector<std::pair<int, int>> mine;   // bookingId, roomId
+
+        for (int i = 0; i < opsPerThread; i++) {
+            int action = (int)(rng() % 4);
+
+            if (action <= 1 || mine.empty()) {
+                int bid = (action == 0) ? hotel.createBooking(cust, pickRoom(rng), 1)
+                                        : hotel.bookAnyRoom(cust, pickType(rng), 1);
+                if (bid > 0) {
+                    int roomId = hotel.getBooking(bid)->roomId;
+                    if (++occupancy[roomId] > 1) violations++;
+                    mine.emplace_back(bid, roomId);
+                }
+            } else {
+                auto held = mine.back();
+                mine.pop_back();
+                occupancy[held.second]--;
+
+                if (action == 2) hotel.cancelBooking(held.first);
+                else hotel.checkoutBooking(held.first, 0.0);
+            }
+            ops++;
+        }
+    };
+
+    auto start = Clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) pool.emplace_back(worker, 1000 + t);
+    for (auto& t : pool) t.join();
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // Final state: every room has at most one Confirmed booking, and a
+    // room is Booked exactly when it has one
+    std::vector<int> confirmed(lastRoom + 1, 0);
+    for (const auto& b : hotel.getBookings())
+        if (b.status == BookingStatus::Confirmed) confirmed[b.roomId]++;
+
+    for (const auto& r : hotel.getRooms()) {
+        if (confirmed[r.roomId] > 1) violations++;
+        if ((r.status == RoomStatus::Booked) != (confirmed[r.roomId] == 1)) violations++;
+    }
+
+    int booked = 0;
+    for (int c : confirmed) booked += c;
+    if (booked != hotel.countBookedRooms()) violations++;
+
+    return { ops / secs, violations.load() };
+}
+
+int main(int argc, char* argv[]) {
+    int maxThreads = (argc > 1) ? std::atoi(argv[1]) : (int)std::max(4u, std::thread::hardware_concurrency());
+    int opsPerThread = (argc > 2) ? std::atoi(argv[2]) : 20000;
+    int roomCount = (argc > 3) ? std::atoi(argv[3]) : 2000;
+
+    char dir[] = "/tmp/hotel_stress_XXXXXX";
+    if (!mkdtemp(dir) || chdir(dir) != 0) {
+        std::cerr << "Cannot create scratch directory\n";
+        return 1;
+    }
+
+    long totalViolations = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        // Fresh data directory per round
+        std::string round = "round_" + std::to_string(threads);
+        std::string mk = "mkdir -p " + round;
+        if (std::system(mk.c_str()) != 0 || chdir(round.c_str()) != 0) return 1;
+
+        Result r = runRound(threads, opsPerThread, roomCount);
+        std::cout << threads << " threads: " << (long)r.opsPerSec << " ops/sec, "
+                  << r.violations << " violations\n";
+        totalViolations += r.violations;
+
+        if (chdir("..") != 0) return 1;
+    }
+
+    if (totalViolations) {
+        std::cout << "FAILED: rooms were double-booked\n";
+        return 1;
+    }
+    std::cout << "OK\n";
+    return 0;
+}
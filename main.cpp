@@ -2,8 +2,19 @@
 #include <string>
 #include <limits>
 #include <regex>
+#include <memory>
+#include <cstdlib>
+#include <csignal>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
 
 #include "Hotel.h"
+#include "HttpServer.h"
+#include "Metrics.h"
+#include "BulkIO.h"
+#include "PropertyRegistry.h"
 
 // ---------- Safe Input Helpers ----------
 
@@ -70,6 +81,15 @@ std::string readDate(const std::string &prompt) {
     }
 }
 
+// Reads a YYYY-MM-DD date as a day number (see Date.h)
+int readDay(const std::string &prompt) {
+    while (true) {
+        int day;
+        if (parseDate(readDate(prompt), day)) return day;
+        std::cout << "No such date. Try again.\n";
+    }
+}
+
 // ---------- Validation helpers for hotel IDs ----------
 
 int readExistingRoomId(Hotel &hotel) {
@@ -146,16 +166,195 @@ void showMenu() {
               << "11. Customer Report\n"
               << "12. Revenue Report\n"
               << "13. Show All Bookings\n"
-              << "14. Generate Web Dashboard\n"  // NEW OPTION
+              << "14. Generate Web Dashboard\n"
+              << "15. Book Any Room of Type\n"
+              << "16. Check Availability for Dates\n"
+              << "17. Reserve Room for Dates\n"
+              << "18. Show Metrics\n"
+              << "19. Memory Report\n"
+              << "20. Find Customer\n"
+              << "21. Batch Invoices for a Day\n"
+              << "22. Occupancy / ADR / RevPAR Report\n"
+              << "23. Quote a Stay\n"
+              << "24. Complete Maintenance Job\n"
+              << "25. Maintenance Queue\n"
+              << "26. Add Staff Member\n"
               << "0. Exit\n"
               << "Choose: ";
 }
 
-int main() {
-    Hotel hotel;
+// ---------- Chain report ----------
+
+// --chain-report DIR,DIR,...: one property per data directory, queried
+// in parallel through a PropertyRegistry
+int chainReport(const std::string& dirs) {
+    PropertyRegistry chain;
+    std::stringstream list(dirs);
+    std::string dir;
+    while (std::getline(list, dir, ','))
+        if (!dir.empty() && chain.addProperty(dir, dir) < 0)
+            std::cout << "Skipping duplicate property " << dir << "\n";
+    if (chain.size() == 0) {
+        std::cout << "--chain-report needs a comma-separated list of data directories.\n";
+        return 1;
+    }
+
+    std::cout << "\n===== CHAIN OCCUPANCY =====\n" << std::fixed << std::setprecision(1);
+    ChainOccupancy occ = chain.chainOccupancy();
+    occ.properties.push_back(occ.total);
+    for (const auto& p : occ.properties)
+        std::cout << "  " << p.property << ": " << p.booked << "/" << p.rooms() << " booked ("
+                  << p.occupancy() << "%), " << p.available << " available, "
+                  << p.maintenance << " in maintenance\n";
+
+    std::cout << "\n===== FREE TONIGHT =====\n";
+    for (const auto& rt : chain.hotel(0).getRoomTypes()) {
+        ChainAvailability free = chain.chainAvailability(rt.typeId, today(), today() + 1);
+        std::cout << "  " << rt.name << ": " << free.totalRooms << " room(s)";
+        for (const auto& p : free.properties) std::cout << ", " << p.property << " " << p.rooms.size();
+        std::cout << "\n";
+    }
+
+    std::cout << "\n===== CHAIN REVENUE =====\n" << std::setprecision(2);
+    ChainRevenue rev = chain.chainRevenue(today() - 365, today() + 1);
+    rev.properties.push_back(rev.total);
+    for (const auto& p : rev.properties)
+        std::cout << "  " << p.property << ": ₹" << p.completed << " completed, ₹"
+                  << p.estimatedActive << " estimated active\n";
+    std::cout << "\nLast 12 months:\n";
+    for (const auto& m : rev.byMonth) {
+        if (m.second == 0.0) continue;
+        std::cout << "  " << m.first / 100 << "-" << std::setw(2) << std::setfill('0')
+                  << m.first % 100 << std::setfill(' ') << ": ₹" << m.second << "\n";
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // Block the stop signals before any server thread exists, so that
+    // --headless can collect them with sigwait()
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    // The data directory and chain reports are needed before loading
+    std::string dataDir;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--headless") pthread_sigmask(SIG_BLOCK, &set, nullptr);
+        else if (arg == "--data-dir" && i + 1 < argc) dataDir = argv[++i];
+        else if (arg == "--chain-report" && i + 1 < argc) return chainReport(argv[++i]);
+    }
+
+    // A damaged data directory is left as it is for the operator
+    std::unique_ptr<Hotel> loaded;
+    try {
+        loaded.reset(new Hotel(dataDir));
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    Hotel& hotel = *loaded;
+    std::unique_ptr<HttpServer> server;
+    bool headless = false;
     int choice;
+    std::string importRooms, importCustomers, importBookings;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--journal") {
+            hotel.enableJournal();
+        } else if (arg == "--group-commit") {
+            hotel.enableGroupCommit();
+        } else if (arg == "--serve" && i + 1 < argc) {
+            server.reset(new HttpServer(hotel, std::atoi(argv[++i])));
+            if (!server->start()) return 1;
+            std::cout << "API listening on http://127.0.0.1:" << server->getPort() << "/\n";
+        } else if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--data-dir" && i + 1 < argc) {
+            i++;   // handled before loading
+        } else if (arg == "--trace" && i + 1 < argc) {
+            // Replay it with build/hotel_replay
+            if (!hotel.startTrace(argv[++i])) {
+                std::cout << "Cannot write trace " << argv[i] << "\n";
+                return 1;
+            }
+        } else if (arg == "--dedup-customers") {
+            hotel.setCustomerDedup(true);
+        } else if (arg == "--convert-dat") {
+            if (!hotel.convertToBinarySnapshot()) {
+                std::cout << "Conversion failed.\n";
+                return 1;
+            }
+            HotelView v = hotel.pinView();
+            std::cout << "Converted " << v.rooms.size() << " rooms, " << v.customers.size()
+                      << " customers and " << v.bookings.size() << " bookings to hotel.snap\n";
+            return 0;
+        } else if (arg == "--invoices" && i + 1 < argc) {
+            // End-of-day run: invoices/<date>/ with an index.csv
+            int day;
+            if (!parseDate(argv[++i], day)) {
+                std::cout << "--invoices needs a YYYY-MM-DD date.\n";
+                return 1;
+            }
+            std::string dir = (dataDir.empty() ? "" : dataDir + "/") + "invoices/" + formatDate(day);
+            std::cout << hotel.writeInvoicesForDay(day, dir) << " invoice(s) written to " << dir << "\n";
+            return 0;
+        } else if (arg == "--import-rooms" && i + 1 < argc) {
+            importRooms = argv[++i];
+        } else if (arg == "--import-customers" && i + 1 < argc) {
+            importCustomers = argv[++i];
+        } else if (arg == "--import-bookings" && i + 1 < argc) {
+            importBookings = argv[++i];
+        } else if ((arg == "--export" || arg == "--export-ndjson") && i + 1 < argc) {
+            auto format = (arg == "--export") ? bulk::Format::Csv : bulk::Format::Ndjson;
+            if (!hotel.exportTables(argv[++i], format)) {
+                std::cout << "Export failed.\n";
+                return 1;
+            }
+            HotelView v = hotel.pinView();
+            std::cout << "Exported " << v.rooms.size() << " rooms, " << v.customers.size()
+                      << " customers and " << v.bookings.size() << " bookings to " << argv[i] << "\n";
+            return 0;
+        } else {
+            std::cout << "Unknown option: " << arg << "\n";
+        }
+    }
+
+    // Bulk import: parse every file, then add them in one go
+    if (!importRooms.empty() || !importCustomers.empty() || !importBookings.empty()) {
+        bulk::Batch batch;
+        bool read = (importRooms.empty() || bulk::readRooms(importRooms, batch)) &&
+                    (importCustomers.empty() || bulk::readCustomers(importCustomers, batch)) &&
+                    (importBookings.empty() || bulk::readBookings(importBookings, batch));
+        bool ok = read && hotel.importBatch(batch);
+
+        for (const auto& e : batch.errors) std::cout << e << "\n";
+        if (batch.rejected > batch.errors.size())
+            std::cout << "... " << batch.rejected - batch.errors.size() << " more rejected rows\n";
+        if (!ok) {
+            std::cout << "Import failed.\n";
+            return 1;
+        }
+        std::cout << "Imported " << batch.importedRooms << " rooms, " << batch.importedCustomers
+                  << " customers and " << batch.importedBookings << " bookings ("
+                  << batch.unchanged << " unchanged, " << batch.rejected
+                  << " rejected) into hotel.snap\n";
+        return 0;
+    }
+
+    // Serve the API without the console menu until SIGINT/SIGTERM
+    if (headless) {
+        int sig;
+        sigwait(&set, &sig);
+        if (server) server->stop();
+        hotel.checkpoint();
+        return 0;
+    }
 
     while (true) {
+        hotel.rollOverDay();
         showMenu();
 
         if (!(std::cin >> choice)) {
@@ -180,8 +379,14 @@ int main() {
             std::string phone = readNonEmptyLine("Phone: ");
             std::string email = readNonEmptyLine("Email: ");
 
+            size_t before = hotel.pinView().customers.size();
             int id = hotel.addCustomer(name, phone, email);
-            std::cout << "Customer added with ID: " << id << "\n";
+            if (id == -3)
+                std::cout << "Customer could not be saved.\n";
+            else if (hotel.pinView().customers.size() == before)
+                std::cout << "Guest already on file with ID: " << id << "\n";
+            else
+                std::cout << "Customer added with ID: " << id << "\n";
 
         } else if (choice == 4) {
             int custId = readExistingCustomerId(hotel);
@@ -194,30 +399,70 @@ int main() {
                 std::cout << "Booking created with ID: " << bid << "\n";
             else if (bid == -2)
                 std::cout << "Room is not available.\n";
+            else if (bid == -3)
+                std::cout << "Booking could not be saved.\n";
             else
                 std::cout << "Error creating booking.\n";
 
         } else if (choice == 5) {
             int bid = readExistingBookingId(hotel);
-            hotel.cancelBooking(bid);
+            if (hotel.cancelBooking(bid))
+                std::cout << "Booking " << bid << " cancelled.\n";
+            else if (Hotel::lastChangeUnsaved())
+                std::cout << "Cancellation could not be saved.\n";
+            else
+                std::cout << "Booking is not active.\n";
 
         } else if (choice == 6) {
             int bid    = readExistingBookingId(hotel);
             double ext = readDoubleMin("Extra charges: ", 0);
-            hotel.checkoutBooking(bid, ext);
+            if (hotel.checkoutBooking(bid, ext))
+                std::cout << "Booking " << bid << " checked out.\n";
+            else if (Hotel::lastChangeUnsaved())
+                std::cout << "Checkout could not be saved.\n";
+            else
+                std::cout << "Checkout failed.\n";
 
         } else if (choice == 7) {
             int roomId = readExistingRoomId(hotel);
             std::string issue = readNonEmptyLine("Issue: ");
             std::string date  = readDate("Scheduled date (YYYY-MM-DD): ");
-            hotel.scheduleMaintenance(roomId, issue, date);
+
+            MaintPriority priority = MaintPriority::Normal;
+            std::string p;
+            while (true) {
+                std::cout << "Priority (urgent/high/normal/low) [normal]: ";
+                std::getline(std::cin, p);
+                if (p.empty() || parsePriority(p, priority)) break;
+                std::cout << "Unknown priority.\n";
+            }
+
+            int id = hotel.scheduleMaintenance(roomId, issue, date, priority);
+            if (id > 0)
+                std::cout << "Maintenance job " << id << " scheduled.\n";
+            else if (id == -2)
+                std::cout << "Cannot schedule maintenance. Room is booked on that day.\n";
+            else if (id == -3)
+                std::cout << "Maintenance job could not be saved.\n";
+            else
+                std::cout << "Invalid maintenance date.\n";
 
         } else if (choice == 8) {
             int roomId = readExistingRoomId(hotel);
-            hotel.toggleRoomMaintenance(roomId);
+            int result = hotel.toggleRoomMaintenance(roomId);
+            if (result == 1)
+                std::cout << "Room " << roomId << " is now under maintenance.\n";
+            else if (result == 0)
+                std::cout << "Room " << roomId << " is back in use.\n";
+            else if (result == -2)
+                std::cout << "Cannot change maintenance status. Room is currently booked.\n";
+            else if (result == -3)
+                std::cout << "Maintenance status could not be saved.\n";
+            else if (result == -4)
+                std::cout << "Room has an open maintenance job; complete it instead (option 24).\n";
 
         } else if (choice == 9) {
-            hotel.saveAll();
+            hotel.checkpoint();
             std::cout << "Data saved.\n";
 
         } else if (choice == 10) {
@@ -234,13 +479,135 @@ int main() {
 
         } else if (choice == 14) {
             hotel.generateDashboardHTML();
-            
+
+        } else if (choice == 15) {
+            for (const auto& t : hotel.getRoomTypes())
+                std::cout << t.typeId << ". " << t.name << " ("
+                          << hotel.freeRoomCount(t.typeId) << " free)\n";
+
+            int custId = readExistingCustomerId(hotel);
+            int typeId = readInt("Room type: ");
+            int days   = readIntMin("Days: ", 1);
+
+            int bid = hotel.bookAnyRoom(custId, typeId, days);
+
+            if (bid > 0)
+                std::cout << "Booking created with ID: " << bid << " (Room "
+                          << hotel.getBooking(bid)->roomId << ")\n";
+            else if (bid == -2)
+                std::cout << "No room of that type is available.\n";
+            else if (bid == -3)
+                std::cout << "Booking could not be saved.\n";
+            else
+                std::cout << "Unknown room type.\n";
+
+        } else if (choice == 16) {
+            int typeId = readInt("Room type: ");
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            int from = readDay("From (YYYY-MM-DD): ");
+            int to   = readDay("To (YYYY-MM-DD): ");
+
+            std::vector<int> free = hotel.findAvailableRooms(typeId, from, to);
+            std::cout << free.size() << " room(s) free:";
+            for (int id : free) std::cout << " " << id;
+            std::cout << "\n";
+
+        } else if (choice == 17) {
+            int custId  = readExistingCustomerId(hotel);
+            int roomId  = readExistingRoomId(hotel);
+            int checkIn = readDay("Check-in (YYYY-MM-DD): ");
+            int nights  = readIntMin("Nights: ", 1);
+
+            int bid = hotel.createReservation(custId, roomId, checkIn, nights);
+
+            if (bid > 0)
+                std::cout << "Reservation created with ID: " << bid << "\n";
+            else if (bid == -2)
+                std::cout << "Room is not free for those dates.\n";
+            else if (bid == -3)
+                std::cout << "Reservation could not be saved.\n";
+            else
+                std::cout << "Invalid reservation dates.\n";
+
+        } else if (choice == 18) {
+            metrics::writeText(std::cout);
+            std::string dir = (dataDir.empty() ? "" : dataDir + "/") + "dashboard";
+            std::error_code ec;
+            std::filesystem::create_directories(dir, ec);
+            if (metrics::enabled() && metrics::writePrometheusFile(dir + "/metrics.prom"))
+                std::cout << "Written to " << dir << "/metrics.prom\n";
+
+        } else if (choice == 19) {
+            hotel.printMemoryReport();
+
+        } else if (choice == 20) {
+            int by = readIntMin("Search by 1) phone 2) email 3) name prefix: ", 1);
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            std::string text = readNonEmptyLine("Search for: ");
+
+            CustomerQuery q;
+            if (by == 1) q.phone = text;
+            else if (by == 2) q.email = text;
+            else q.namePrefix = text;
+
+            auto found = hotel.findCustomers(q);
+            for (const auto& c : found) {
+                std::cout << "ID: " << c.custId << " | " << c.name << " | "
+                          << c.phone << " | " << c.email << "\n";
+            }
+            if (found.empty()) std::cout << "No matching customers.\n";
+
+        } else if (choice == 21) {
+            int day = readDay("Paid on (YYYY-MM-DD): ");
+            std::string dir = (dataDir.empty() ? "" : dataDir + "/") + "invoices/" + formatDate(day);
+            size_t n = hotel.writeInvoicesForDay(day, dir);
+            std::cout << n << " invoice(s) written to " << dir << " (see index.csv)\n";
+
+        } else if (choice == 22) {
+            hotel.printOccupancyReport();
+
+        } else if (choice == 23) {
+            int roomId  = readExistingRoomId(hotel);
+            int checkIn = readDay("Check-in (YYYY-MM-DD): ");
+            int nights  = readIntMin("Nights: ", 1);
+
+            double amount = hotel.quoteStay(roomId, checkIn, nights);
+            std::ios::fmtflags flags = std::cout.flags();
+            std::cout << std::fixed << std::setprecision(2)
+                      << "Room charge: ₹" << amount << " (₹" << amount / nights
+                      << " per night, before extras and tax)\n";
+            std::cout.flags(flags);
+            std::cout << std::setprecision(6);
+
+        } else if (choice == 24) {
+            int id = readInt("Job ID: ");
+            if (hotel.completeMaintenance(id))
+                std::cout << "Job " << id << " completed.\n";
+            else if (Hotel::lastChangeUnsaved())
+                std::cout << "Job " << id << " completed, but could not be saved.\n";
+            else
+                std::cout << "No job " << id << " in progress.\n";
+
+        } else if (choice == 25) {
+            hotel.printMaintenanceQueue();
+
+        } else if (choice == 26) {
+            std::string name = readNonEmptyLine("Name: ");
+            std::string role = readNonEmptyLine("Role (Technician takes maintenance jobs): ");
+            double salary    = readDoubleMin("Salary: ", 0);
+            int id = hotel.addStaff(name, role, salary);
+            if (id == -3)
+                std::cout << "Staff member could not be saved.\n";
+            else
+                std::cout << "Staff member added with ID: " << id << "\n";
+
         } else {
             std::cout << "Invalid menu option.\n";
         }
     }
 
-    hotel.saveAll();
+    if (server) server->stop();
+    hotel.checkpoint();
     std::cout << "Goodbye!\n";
     return 0;
 }
@@ -0,0 +1,314 @@
+// Regression tests for the storage and request paths that have no
+// interactive way to fail: journal replay, generation recovery, the
+// HTTP limits and bulk import validation. Each case runs in its own
+// scratch directory under the system temp directory.
+//
+//   ./hotel_tests          (or ctest)
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../BulkIO.h"
+#include "../Generations.h"
+#include "../Hotel.h"
+#include "../HttpServer.h"
+#include "../Journal.h"
+
+namespace fs = std::filesystem;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed\n"; \
+            failures++;                                                          \
+        }                                                                        \
+    } while (0)
+
+// An empty directory for one test case
+static std::string scratch(const std::string& name) {
+    fs::path p = fs::temp_directory_path() / ("hotel_tests_" + std::to_string(getpid())) / name;
+    std::error_code ec;
+    fs::remove_all(p, ec);
+    fs::create_directories(p);
+    return p.string();
+}
+
+static void writeFile(const std::string& path, const std::string& text, bool append = false) {
+    std::ofstream f(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+    f << text;
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+}
+
+/* ================= Journal ================= */
+
+static void journalReplay() {
+    std::string dir = scratch("journal");
+    std::string path = dir + "/journal.log";
+    {
+        Journal j(path);
+        j.setSync(false);
+        CHECK(j.open());
+        for (int i = 1; i <= 3; i++) CHECK(j.append(JournalEntry().add("op").add(i)));
+    }
+
+    std::vector<int> seen;
+    auto collect = [&](const std::vector<std::string>& f) { seen.push_back(std::stoi(f.at(1))); };
+    CHECK(Journal::replay(path, collect) == 3);
+    CHECK((seen == std::vector<int>{ 1, 2, 3 }));
+
+    // A record cut short by a crash ends the replay without failing it
+    std::string torn = JournalEntry().add("op").add(4).encode();
+    writeFile(path, torn.substr(0, torn.size() - 1), true);
+    seen.clear();
+    CHECK(Journal::replay(path, collect) == 3);
+
+    // So does a corrupt one, and nothing after it is applied
+    std::string corrupt = JournalEntry().add("op").add(5).encode();
+    corrupt[0] = 'O';
+    std::string good;
+    for (int i = 1; i <= 3; i++) good += JournalEntry().add("op").add(i).encode();
+    writeFile(path, good + corrupt + JournalEntry().add("op").add(6).encode());
+    seen.clear();
+    CHECK(Journal::replay(path, collect) == 3);
+    CHECK((seen == std::vector<int>{ 1, 2, 3 }));
+}
+
+// Journaled changes survive a restart; a torn tail loses only itself
+static void journalRestart() {
+    std::string dir = scratch("journal_restart");
+    int first, second;
+    {
+        Hotel h(dir);
+        h.enableJournal(1000, false);
+        first = h.addCustomer("Ann", "555-0101", "ann@example.com");
+        second = h.addCustomer("Bob", "555-0102", "bob@example.com");
+        CHECK(first > 0 && second > 0);
+    }
+
+    std::string segment;
+    for (const auto& e : fs::directory_iterator(dir)) {
+        std::string name = e.path().filename().string();
+        if (name.compare(0, 8, "journal-") == 0 && e.path().string() > segment) segment = e.path().string();
+    }
+    CHECK(!segment.empty());
+    writeFile(segment, "half a rec", true);
+
+    Hotel h(dir);
+    CHECK(h.hasCustomer(first));
+    CHECK(h.hasCustomer(second));
+}
+
+/* ================= Generations ================= */
+
+static void generationFallback() {
+    std::string dir = scratch("generations");
+    GenerationStore store(dir);
+    CHECK(!store.recover());
+    CHECK(!store.damaged());
+
+    for (const char* text : { "first", "second" }) {
+        std::string d = store.begin();
+        CHECK(!d.empty());
+        writeFile(d + "/rooms.dat", text);
+        CHECK(store.commit({ "rooms.dat" }));
+    }
+    CHECK(store.current() == 2);
+    CHECK(store.fallback() == 1);
+
+    // A damaged newest generation falls back to the one before it
+    writeFile(dir + "/gen-000002/rooms.dat", "SECOND");
+    GenerationStore reopened(dir);
+    CHECK(reopened.recover());
+    CHECK(reopened.current() == 1);
+    CHECK(readFile(reopened.path("rooms.dat")) == "first");
+
+    // A save that never committed is skipped without damaging the store
+    fs::create_directories(dir + "/gen-000003");
+    GenerationStore interrupted(dir);
+    CHECK(interrupted.recover());
+    CHECK(interrupted.current() == 1);
+    CHECK(!interrupted.damaged());
+}
+
+static void generationDamaged() {
+    std::string dir = scratch("damaged");
+    {
+        GenerationStore store(dir);
+        store.recover();
+        std::string d = store.begin();
+        writeFile(d + "/rooms.dat", "rooms");
+        CHECK(store.commit({ "rooms.dat" }));
+    }
+    writeFile(dir + "/gen-000001/rooms.dat", "ROOMS!");
+
+    GenerationStore store(dir);
+    CHECK(!store.recover());
+    CHECK(store.damaged());
+    CHECK(store.begin().empty());
+    CHECK(fs::exists(dir + "/gen-000001/MANIFEST"));
+
+    // Hotel refuses to start from it rather than pruning it
+    bool refused = false;
+    try {
+        Hotel h(dir);
+    } catch (const std::runtime_error&) {
+        refused = true;
+    }
+    CHECK(refused);
+    CHECK(readFile(dir + "/gen-000001/rooms.dat") == "ROOMS!");
+}
+
+/* ================= HTTP ================= */
+
+static int statusOf(HttpServer& server, const std::string& method, const std::string& path,
+                    std::map<std::string, std::string> params = {}) {
+    HttpServer::Request req;
+    req.method = method;
+    req.path = path;
+    req.params = std::move(params);
+    return server.handle(req).status;
+}
+
+static int processOf(HttpServer& server, const std::string& input, std::string* out = nullptr) {
+    HttpServer::Connection c;
+    c.in = input;
+    int status = server.process(c);
+    if (out) *out = c.out;
+    return status;
+}
+
+static void httpLimits() {
+    std::string dir = scratch("http");
+    Hotel h(dir);
+    HttpServer server(h, 0, 1);   // never started: no sockets
+
+    // Malformed numbers are refused, not truncated or wrapped
+    CHECK(statusOf(server, "GET", "/api/customers", { { "limit", "12x" } }) == 400);
+    CHECK(statusOf(server, "GET", "/api/rooms/available", { { "typeId", "99999999999" } }) == 400);
+    CHECK(statusOf(server, "GET", "/api/customers", { { "name", "A" }, { "limit", "5" } }) == 200);
+
+    int cust = h.addCustomer("Cara", "555-0103", "cara@example.com");
+    int bid = h.createBooking(cust, h.getRooms().front().roomId, 2);
+    CHECK(bid > 0);
+    std::string checkout = "/api/bookings/" + std::to_string(bid) + "/checkout";
+    CHECK(statusOf(server, "POST", checkout, { { "extra", "12abc" } }) == 400);
+    CHECK(statusOf(server, "POST", checkout, { { "extra", "-5" } }) == 400);
+    CHECK(h.getBooking(bid)->status == BookingStatus::Confirmed);
+    CHECK(statusOf(server, "POST", checkout, { { "extra", "250" } }) == 200);
+    h.flushInvoices();
+
+    // Listing maintenance is read-only
+    CHECK(statusOf(server, "GET", "/api/maintenance") == 200);
+
+    // Request framing, before any handler runs
+    std::string out;
+    CHECK(processOf(server, "GET /api/bookings/" + std::to_string(bid) + " HTTP/1.1\r\n\r\n", &out) == 0);
+    CHECK(out.compare(0, 15, "HTTP/1.1 200 OK") == 0);
+    CHECK(processOf(server, "GET / HTTP/1.1\r\nX-Pad: " + std::string(70000, 'a')) == 431);
+    CHECK(processOf(server, "POST /api/customers HTTP/1.1\r\nContent-Length: 2000000\r\n\r\n") == 413);
+    CHECK(processOf(server, "NONSENSE\r\n\r\n") == 400);
+    // An incomplete request waits for more input
+    CHECK(processOf(server, "GET /api/dashboard HTTP/1.1\r\nHost: x") == 0);
+}
+
+/* ================= Dashboard export ================= */
+
+// Concurrent exports to one path each replace it whole and leave no
+// temp files behind
+static void exportConcurrent() {
+    std::string dir = scratch("export");
+    Hotel h(dir);
+
+    std::vector<std::thread> threads;
+    std::atomic<int> failed{0};
+    for (int t = 0; t < 4; t++)
+        threads.emplace_back([&] {
+            for (int i = 0; i < 25; i++)
+                if (!h.exportToJSON("dashboard.json")) failed++;
+        });
+    for (auto& t : threads) t.join();
+
+    CHECK(failed == 0);
+    std::string json = readFile(dir + "/dashboard.json");
+    CHECK(!json.empty() && json.front() == '{' && json.compare(json.size() - 2, 2, "}\n") == 0);
+    size_t files = 0;
+    for (const auto& e : fs::directory_iterator(dir))
+        if (e.path().filename().string().compare(0, 14, "dashboard.json") == 0) files++;
+    CHECK(files == 1);
+}
+
+/* ================= Bulk import ================= */
+
+static void importValidation() {
+    std::string dir = scratch("import");
+    Hotel h(dir);
+
+    writeFile(dir + "/rooms.csv",
+              "roomId,typeId\n"
+              "5001,1\n"
+              "5002,9\n"        // unknown typeId
+              "5001,2\n");      // duplicate roomId
+    writeFile(dir + "/customers.csv",
+              "custId,name,phone,email\n"
+              "7001,Dana,555-0104,dana@example.com\n");
+    writeFile(dir + "/bookings.csv",
+              "bookingId,custId,roomId,checkIn,days\n"
+              "9001,7001,5001,2030-01-01,2\n"
+              "9002,424242,5001,2030-02-01,1\n"   // unknown custId
+              "9003,7001,777777,2030-03-01,1\n"   // unknown roomId
+              "9004,7001,5001,not-a-date,1\n");   // malformed
+
+    bulk::Batch batch;
+    CHECK(bulk::readRooms(dir + "/rooms.csv", batch));
+    CHECK(bulk::readCustomers(dir + "/customers.csv", batch));
+    CHECK(bulk::readBookings(dir + "/bookings.csv", batch));
+    CHECK(h.importBatch(batch));
+
+    CHECK(batch.importedRooms == 1);
+    CHECK(batch.importedCustomers == 1);
+    CHECK(batch.importedBookings == 1);
+    CHECK(batch.rejected == 5);
+    CHECK(batch.errors.size() == 5);
+    CHECK(h.getRoom(5001) && h.getRoom(5001)->typeId == 1);
+    CHECK(!h.hasRoom(5002));
+    CHECK(h.hasBooking(9001) && !h.hasBooking(9002) && !h.hasBooking(9003));
+
+    // A file without a required column is refused outright
+    writeFile(dir + "/bad.csv", "roomId,status\n5003,available\n");
+    bulk::Batch bad;
+    CHECK(!bulk::readRooms(dir + "/bad.csv", bad));
+}
+
+int main() {
+    journalReplay();
+    journalRestart();
+    generationFallback();
+    generationDamaged();
+    httpLimits();
+    exportConcurrent();
+    importValidation();
+
+    std::error_code ec;
+    fs::remove_all(fs::temp_directory_path() / ("hotel_tests_" + std::to_string(getpid())), ec);
+
+    if (failures) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All checks passed\n";
+    return 0;
+}